@@ -35,6 +35,8 @@ SOFTWARE.
 #include <Hork/World/Modules/Render/RenderInterface.h>
 #include <Hork/World/Modules/Input/InputInterface.h>
 
+#include "Common/HeadlessRunner.h"
+
 using namespace Hk;
 
 class PlayerComponent : public Component
@@ -108,9 +110,13 @@ class SampleApplication final : public GameApplication
     Ref<WorldRenderView>        m_WorldRenderView;
     Handle32<CameraComponent>   m_MainCamera;
 
+    // Headless runs keep the UI and only time the frames
+    HeadlessRunner              m_Headless;
+
 public:
     SampleApplication(ArgumentPack const& args) :
-        GameApplication(args, "Hork Engine: Hello World")
+        GameApplication(args, "Hork Engine: Hello World"),
+        m_Headless(args)
     {}
 
     void Initialize()
@@ -188,6 +194,12 @@ public:
         render.SetAmbient(0.1f);
 
         CreateScene();
+
+        sGetStateMachine().Bind("State_Play", this, {}, {}, &SampleApplication::OnUpdate);
+        sGetStateMachine().MakeCurrent("State_Play");
+
+        if (m_Headless.IsEnabled())
+            m_Headless.Start(m_World);
     }
 
     void Deinitialize()
@@ -323,6 +335,12 @@ public:
     {
         PostTerminateEvent();
     }
+
+    void OnUpdate(float timeStep)
+    {
+        if (m_Headless.Update())
+            PostTerminateEvent();
+    }
 };
 
 using ApplicationClass = SampleApplication;
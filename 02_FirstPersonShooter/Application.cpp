@@ -32,13 +32,19 @@ SOFTWARE.
 
 #include "Application.h"
 
-#include "Common/MapParser/Utils.h"
-
 #include "Common/Components/FirstPersonComponent.h"
 #include "Common/Components/JumpadComponent.h"
 #include "Common/Components/TeleporterComponent.h"
 #include "Common/Components/ElevatorComponent.h"
+#include "Common/Interfaces/ProjectileInterface.h"
+#include "Common/Interfaces/PlayerInputInterface.h"
+#include "Common/Interfaces/RandomInterface.h"
 #include "Common/CollisionLayer.h"
+#include "Common/TraceProfiler.h"
+#include "Common/TickStats.h"
+#include "Common/MemoryTags.h"
+
+#include <Hork/Core/Logger.h>
 
 #include <Hork/UI/UIViewport.h>
 #include <Hork/UI/UIGrid.h>
@@ -60,18 +66,155 @@ SOFTWARE.
 #include <Hork/World/Modules/Audio/AudioInterface.h>
 #include <Hork/World/Modules/Audio/Components/SoundSource.h>
 
+#include <cstdlib>
+
 #define SPLIT_SCREEN
 
 using namespace Hk;
 
+namespace
+{
+    const float LoadingProgressWidth = 400;
+    const float LoadingProgressHeight = 8;
+
+    // The scene objects are placed for sample2, so the rotation loops over that one map on purpose:
+    // the next level reloads it into a fresh world. Maps of a longer rotation are tried in order when one fails to load.
+    const char* MapRotation[] = {"/Root/sample2.map"};
+}
+
 SampleApplication::SampleApplication(ArgumentPack const& args) :
-    GameApplication(args, "Hork Engine: First Person Shooter")
-{}
+    GameApplication(args, "Hork Engine: First Person Shooter"),
+    m_Headless(args)
+{
+    int i = args.Find("-seed");
+    if (i != -1 && i + 1 < args.Size())
+    {
+        m_Seed = uint32_t(std::strtoul(args.At(i + 1), nullptr, 10));
+        m_HasSeed = true;
+    }
+
+    i = args.Find("-replay");
+    if (i != -1 && i + 1 < args.Size() && m_Replay.Load(args.At(i + 1)))
+    {
+        // The recorded seed wins, otherwise the replay diverges
+        m_Seed = m_Replay.GetSeed();
+        m_HasSeed = true;
+        m_IsReplaying = true;
+    }
+
+    i = args.Find("-record");
+    if (i != -1 && i + 1 < args.Size())
+    {
+        if (!m_HasSeed)
+        {
+            m_Seed = sGetRandom().Get();
+            m_HasSeed = true;
+        }
+        m_RecordFile = args.At(i + 1);
+        m_Recorder.Begin(2, m_Seed);
+    }
+
+    // Benchmark runs drive both players with scripted input and a fixed seed
+    if (m_Headless.IsScripted() && !m_IsReplaying)
+    {
+        if (!m_HasSeed)
+        {
+            m_Seed = 1;
+            m_HasSeed = true;
+        }
+        m_Replay.Generate(2, m_Headless.GetTickCount(), m_Seed);
+        m_IsReplaying = true;
+    }
+
+    // Write a trace of every frame longer than the budget in milliseconds
+    i = args.Find("-hitch");
+    if (i != -1 && i + 1 < args.Size())
+        TraceProfiler::sGet().SetHitchBudget(float(std::atof(args.At(i + 1))));
+}
 
 SampleApplication::~SampleApplication()
 {}
 
 void SampleApplication::Initialize()
+{
+    // Headless runs only simulate the world unless frame building is measured too
+    if (m_Headless.IsRenderEnabled())
+        CreateUI();
+
+    // Set input mappings
+    Ref<InputMappings> inputMappings = MakeRef<InputMappings>();
+    inputMappings->MapAxis(PlayerController::_2, "MoveForward", VirtualKey::W, 1);
+    inputMappings->MapAxis(PlayerController::_2, "MoveForward", VirtualKey::S, -1);
+    inputMappings->MapAxis(PlayerController::_2, "MoveForward", VirtualKey::Up, 1);
+    inputMappings->MapAxis(PlayerController::_2, "MoveForward", VirtualKey::Down, -1);
+    inputMappings->MapAxis(PlayerController::_2, "MoveRight",   VirtualKey::A, -1);
+    inputMappings->MapAxis(PlayerController::_2, "MoveRight",   VirtualKey::D, 1);
+
+    inputMappings->MapAxis(PlayerController::_2, "MoveUp",      VirtualKey::Space, 1.0f);
+    inputMappings->MapAxis(PlayerController::_2, "TurnRight",   VirtualKey::Left, -200.0f);
+    inputMappings->MapAxis(PlayerController::_2, "TurnRight",   VirtualKey::Right, 200.0f);
+
+    inputMappings->MapAxis(PlayerController::_2, "FreelookHorizontal", VirtualAxis::MouseHorizontal, 1.0f);
+    inputMappings->MapAxis(PlayerController::_2, "FreelookVertical",   VirtualAxis::MouseVertical, 1.0f);
+    
+    inputMappings->MapAction(PlayerController::_2, "Attack",    VirtualKey::MouseLeftBtn, {});
+    inputMappings->MapAction(PlayerController::_2, "Attack",    VirtualKey::LeftControl, {});
+    inputMappings->MapAction(PlayerController::_2, "SwitchWeapon", VirtualKey::Q, {});
+
+    inputMappings->MapGamepadAction(PlayerController::_1,   "Attack",       GamepadKey::X);
+    inputMappings->MapGamepadAction(PlayerController::_1,   "Attack",       GamepadAxis::TriggerRight);
+    inputMappings->MapGamepadAction(PlayerController::_1,   "SwitchWeapon", GamepadKey::Y);
+    inputMappings->MapGamepadAxis(PlayerController::_1,     "MoveForward",  GamepadAxis::LeftY, 1);
+    inputMappings->MapGamepadAxis(PlayerController::_1,     "MoveRight",    GamepadAxis::LeftX, 1);
+    inputMappings->MapGamepadAxis(PlayerController::_1,     "MoveUp",       GamepadKey::A, 1);
+    inputMappings->MapGamepadAxis(PlayerController::_1,     "TurnRight",    GamepadAxis::RightX, 200.0f);
+    inputMappings->MapGamepadAxis(PlayerController::_1,     "TurnUp",       GamepadAxis::RightY, 200.0f);
+
+    inputMappings->MapGamepadAction(PlayerController::_2,   "Attack",       GamepadKey::X);
+    inputMappings->MapGamepadAction(PlayerController::_2,   "Attack",       GamepadAxis::TriggerRight);
+    inputMappings->MapGamepadAction(PlayerController::_2,   "SwitchWeapon", GamepadKey::Y);
+    inputMappings->MapGamepadAxis(PlayerController::_2,     "MoveForward",  GamepadAxis::LeftY, 1);
+    inputMappings->MapGamepadAxis(PlayerController::_2,     "MoveRight",    GamepadAxis::LeftX, 1);
+    inputMappings->MapGamepadAxis(PlayerController::_2,     "MoveUp",       GamepadKey::A, 1);
+    inputMappings->MapGamepadAxis(PlayerController::_2,     "TurnRight",    GamepadAxis::RightX, 200.0f);
+    inputMappings->MapGamepadAxis(PlayerController::_2,     "TurnUp",       GamepadAxis::RightY, 200.0f);
+
+    sGetInputSystem().SetInputMappings(inputMappings);
+
+    // Create game resources
+    CreateResources();
+
+    // The map is streamed by sectors around the players
+    for (LevelLoader& level : m_Levels)
+    {
+        level.Streaming = true;
+
+        MapStreamer& streamer = level.GetStreamer();
+        streamer.SectorSize = 16;
+        streamer.LoadDistance = 32;
+        streamer.UnloadDistance = 48;
+    }
+
+    auto& stateMachine = sGetStateMachine();
+
+    stateMachine.Bind("State_Loading", this, &SampleApplication::OnStartLoading, {}, &SampleApplication::OnUpdateLoading);
+    stateMachine.Bind("State_Play", this, &SampleApplication::OnStartPlay, {}, &SampleApplication::OnUpdatePlay);
+
+    stateMachine.MakeCurrent("State_Loading");
+
+    TraceProfiler::sGet().RegisterCommands();
+    TickStats::sGet().RegisterCommands();
+    MemoryTracker::sGet().RegisterCommands();
+
+    if (!m_Headless.IsEnabled())
+    {
+        sGetCommandProcessor().Add("com_ShowStat 1\n");
+        sGetCommandProcessor().Add("com_ShowFPS 1\n");
+        sGetCommandProcessor().Add("com_MaxFPS 0\n");
+    }
+}
+
+void SampleApplication::CreateUI()
 {
     // Create UI
     UIDesktop* desktop = UINew(UIDesktop);
@@ -85,6 +228,7 @@ void SampleApplication::Initialize()
     shortcuts->AddShortcut(VirtualKey::P, {}, {this, &SampleApplication::Pause});
     shortcuts->AddShortcut(VirtualKey::Escape, {}, {this, &SampleApplication::Quit});
     shortcuts->AddShortcut(VirtualKey::Y, {}, {this, &SampleApplication::ToggleWireframe});
+    shortcuts->AddShortcut(VirtualKey::N, {}, {this, &SampleApplication::NextLevel});
     desktop->SetShortcuts(shortcuts);
 
     // Create viewport
@@ -136,58 +280,11 @@ void SampleApplication::Initialize()
     // Hide mouse cursor
     GUIManager->bCursorVisible = false;
 
-    // Set input mappings
-    Ref<InputMappings> inputMappings = MakeRef<InputMappings>();
-    inputMappings->MapAxis(PlayerController::_2, "MoveForward", VirtualKey::W, 1);
-    inputMappings->MapAxis(PlayerController::_2, "MoveForward", VirtualKey::S, -1);
-    inputMappings->MapAxis(PlayerController::_2, "MoveForward", VirtualKey::Up, 1);
-    inputMappings->MapAxis(PlayerController::_2, "MoveForward", VirtualKey::Down, -1);
-    inputMappings->MapAxis(PlayerController::_2, "MoveRight",   VirtualKey::A, -1);
-    inputMappings->MapAxis(PlayerController::_2, "MoveRight",   VirtualKey::D, 1);
-
-    inputMappings->MapAxis(PlayerController::_2, "MoveUp",      VirtualKey::Space, 1.0f);
-    inputMappings->MapAxis(PlayerController::_2, "TurnRight",   VirtualKey::Left, -200.0f);
-    inputMappings->MapAxis(PlayerController::_2, "TurnRight",   VirtualKey::Right, 200.0f);
-
-    inputMappings->MapAxis(PlayerController::_2, "FreelookHorizontal", VirtualAxis::MouseHorizontal, 1.0f);
-    inputMappings->MapAxis(PlayerController::_2, "FreelookVertical",   VirtualAxis::MouseVertical, 1.0f);
-    
-    inputMappings->MapAction(PlayerController::_2, "Attack",    VirtualKey::MouseLeftBtn, {});
-    inputMappings->MapAction(PlayerController::_2, "Attack",    VirtualKey::LeftControl, {});
-
-    inputMappings->MapGamepadAction(PlayerController::_1,   "Attack",       GamepadKey::X);
-    inputMappings->MapGamepadAction(PlayerController::_1,   "Attack",       GamepadAxis::TriggerRight);
-    inputMappings->MapGamepadAxis(PlayerController::_1,     "MoveForward",  GamepadAxis::LeftY, 1);
-    inputMappings->MapGamepadAxis(PlayerController::_1,     "MoveRight",    GamepadAxis::LeftX, 1);
-    inputMappings->MapGamepadAxis(PlayerController::_1,     "MoveUp",       GamepadKey::A, 1);
-    inputMappings->MapGamepadAxis(PlayerController::_1,     "TurnRight",    GamepadAxis::RightX, 200.0f);
-    inputMappings->MapGamepadAxis(PlayerController::_1,     "TurnUp",       GamepadAxis::RightY, 200.0f);
-
-    inputMappings->MapGamepadAction(PlayerController::_2,   "Attack",       GamepadKey::X);
-    inputMappings->MapGamepadAction(PlayerController::_2,   "Attack",       GamepadAxis::TriggerRight);
-    inputMappings->MapGamepadAxis(PlayerController::_2,     "MoveForward",  GamepadAxis::LeftY, 1);
-    inputMappings->MapGamepadAxis(PlayerController::_2,     "MoveRight",    GamepadAxis::LeftX, 1);
-    inputMappings->MapGamepadAxis(PlayerController::_2,     "MoveUp",       GamepadKey::A, 1);
-    inputMappings->MapGamepadAxis(PlayerController::_2,     "TurnRight",    GamepadAxis::RightX, 200.0f);
-    inputMappings->MapGamepadAxis(PlayerController::_2,     "TurnUp",       GamepadAxis::RightY, 200.0f);
-
-    sGetInputSystem().SetInputMappings(inputMappings);
-
-    // Create game resources
-    CreateResources();
-
-    // Create game world
-    m_World = CreateWorld();
-
-    // Setup world collision
-    m_World->GetInterface<PhysicsInterface>().SetCollisionFilter(CollisionLayer::CreateFilter());
-
-    // Set rendering parameters
+    // Set rendering parameters. The world is set when a level is activated.
 #ifdef SPLIT_SCREEN
     for (int i = 0; i < 2; ++i)
     {
         m_WorldRenderView[i] = MakeRef<WorldRenderView>();
-        m_WorldRenderView[i]->SetWorld(m_World);
         m_WorldRenderView[i]->bClearBackground = false;
         m_WorldRenderView[i]->bDrawDebug = true;
     }
@@ -195,82 +292,199 @@ void SampleApplication::Initialize()
     m_Viewports[1]->SetWorldRenderView(m_WorldRenderView[1]);
 #else
     m_WorldRenderView[0] = MakeRef<WorldRenderView>();
-    m_WorldRenderView[0]->SetWorld(m_World);
     m_WorldRenderView[0]->bClearBackground = true;
     m_WorldRenderView[0]->BackgroundColor = Color4(0.2f, 0.2f, 0.3f, 1);
     m_WorldRenderView[0]->bDrawDebug = true;
     mainViewport->SetWorldRenderView(m_WorldRenderView[0]);
 #endif
+}
 
-    // Create scene
-    CreateScene();
+void SampleApplication::Deinitialize()
+{
+    if (m_Recorder.IsRecording())
+        m_Recorder.Save(m_RecordFile);
 
-    // Create players
-    GameObject* player = CreatePlayer(m_PlayerSpawnPoints[0].Position, m_PlayerSpawnPoints[0].Rotation, PlayerTeam::Blue);
-    GameObject* player2 = CreatePlayer(m_PlayerSpawnPoints[1].Position, m_PlayerSpawnPoints[1].Rotation, PlayerTeam::Red);
+    for (int levelIndex = 0; levelIndex < HK_ARRAY_SIZE(m_Levels); ++levelIndex)
+        UnloadLevel(levelIndex);
+    m_World = nullptr;
+}
 
-    if (GameObject* camera = player->FindChildren(StringID("Camera")))
+void SampleApplication::OnStartLoading()
+{
+    ShowLoadingScreen(true);
+
+    BeginLevel(m_CurrentLevel, m_MapIndex);
+
+    // Nothing else is running, so use a larger budget than for background loading
+    m_Levels[m_CurrentLevel].BudgetMs = 8;
+}
+
+void SampleApplication::OnUpdateLoading(float timeStep)
+{
+    TraceProfiler::sGet().NextFrame();
+    TickStats::sGet().NextFrame();
+
+    LevelLoader& level = m_Levels[m_CurrentLevel];
+
+    bool isDone = level.Update();
+
+    if (level.IsFailed())
     {
-        // Set camera for rendering
-        m_WorldRenderView[0]->SetCamera(camera->GetComponentHandle<CameraComponent>());
-    
-        // Set audio listener
-        auto& audio = m_World->GetInterface<AudioInterface>();
-        audio.SetListener(camera->GetComponentHandle<AudioListenerComponent>());
+        UnloadLevel(m_CurrentLevel);
+
+        // Try the next map of the rotation, give up when none of them loads
+        if (++m_FailedLoadCount < HK_ARRAY_SIZE(MapRotation))
+        {
+            m_MapIndex = (m_MapIndex + 1) % HK_ARRAY_SIZE(MapRotation);
+            BeginLevel(m_CurrentLevel, m_MapIndex);
+        }
+        else
+        {
+            LOG("Failed to load any map of the rotation\n");
+            PostTerminateEvent();
+        }
+        return;
     }
 
-#ifdef SPLIT_SCREEN
-    if (GameObject* camera = player2->FindChildren(StringID("Camera")))
+    if (m_LoadingProgress)
+        m_LoadingProgress->WithSize(Float2(LoadingProgressWidth * level.GetProgress(), LoadingProgressHeight));
+
+    if (isDone)
     {
-        // Set camera for rendering
-        m_WorldRenderView[1]->SetCamera(camera->GetComponentHandle<CameraComponent>());
+        ActivateLevel(m_CurrentLevel);
+        sGetStateMachine().MakeCurrent("State_Play");
     }
-#endif
-    // Bind input to the player
-    InputInterface& input = m_World->GetInterface<InputInterface>();
-    input.SetActive(true);
-    input.BindInput(player->GetComponentHandle<FirstPersonComponent>(), PlayerController::_2);    
+}
 
-    input.BindInput(player2->GetComponentHandle<FirstPersonComponent>(), PlayerController::_1);
+void SampleApplication::OnUpdatePlay(float timeStep)
+{
+    TraceProfiler::sGet().NextFrame();
+    TickStats::sGet().NextFrame();
 
-    RenderInterface& render = m_World->GetInterface<RenderInterface>();
-    render.SetAmbient(0.1f);
+    if (m_Headless.Update())
+    {
+        PostTerminateEvent();
+        return;
+    }
 
-    auto& stateMachine = sGetStateMachine();
+    // Streams the sectors around the players
+    m_Levels[m_CurrentLevel].Update();
 
-    stateMachine.Bind("State_Loading", this, &SampleApplication::OnStartLoading, {}, &SampleApplication::OnUpdateLoading);
-    stateMachine.Bind("State_Play", this, &SampleApplication::OnStartPlay, {}, {});
+    // Construct the next level in the background and switch as soon as it is ready.
+    // If it fails to load, the current level keeps running.
+    int nextLevel = m_CurrentLevel ^ 1;
+    if (m_Levels[nextLevel].IsFailed())
+        UnloadLevel(nextLevel);
+    else if (m_Levels[nextLevel].IsLoading() && m_Levels[nextLevel].Update())
+        ActivateLevel(nextLevel);
+}
 
-    stateMachine.MakeCurrent("State_Loading");
+World* SampleApplication::CreateGameWorld()
+{
+    World* world = CreateWorld();
+
+    // Setup world collision
+    world->GetInterface<PhysicsInterface>().SetCollisionFilter(CollisionLayer::CreateFilter());
+
+    RenderInterface& render = world->GetInterface<RenderInterface>();
+    render.SetAmbient(0.1f);
 
-    sGetCommandProcessor().Add("com_ShowStat 1\n");
-    sGetCommandProcessor().Add("com_ShowFPS 1\n");
-    sGetCommandProcessor().Add("com_MaxFPS 0\n");
+    if (m_HasSeed)
+        world->GetInterface<RandomInterface>().SetSeed(m_Seed);
+
+    return world;
 }
 
-void SampleApplication::Deinitialize()
+void SampleApplication::BeginLevel(int levelIndex, int mapIndex)
 {
-    DestroyWorld(m_World);
+    auto& resourceMngr = sGetResourceManager();
+
+    // List of resources used in scene
+    ResourceID sceneResources[] = {
+        resourceMngr.GetResource<MeshResource>("/Root/default/skybox.mesh"),
+        resourceMngr.GetResource<MeshResource>("/Root/default/box.mesh"),
+        resourceMngr.GetResource<MeshResource>("/Root/default/sphere.mesh"),
+        resourceMngr.GetResource<MeshResource>("/Root/default/capsule.mesh"),
+        resourceMngr.GetResource<MaterialResource>("/Root/default/materials/mg/default.mg"),
+        resourceMngr.GetResource<MaterialResource>("/Root/default/materials/mg/skybox.mg"),
+        //resourceMngr.GetResource<TextureResource>("/Root/dirt.png"),
+        resourceMngr.GetResource<TextureResource>("/Root/grid8.webp"),
+        resourceMngr.GetResource<TextureResource>("/Root/blank256.webp"),
+        resourceMngr.GetResource<TextureResource>("/Root/blank512.webp"),
+        resourceMngr.GetResource<TextureResource>("/Root/red512.png")
+    };
+
+    // Resources are loaded asynchronously, the map is parsed and built on a worker thread
+    m_Levels[levelIndex].Begin(CreateGameWorld(), MapRotation[mapIndex], sceneResources,
+        [this, levelIndex](World* world, SceneConstructionQueue& queue)
+        {
+            PopulateScene(world, queue);
+
+            // The level is ready when the sectors around the spawn points are loaded
+            for (SpawnPoint const& spawnPoint : m_PlayerSpawnPoints)
+                m_Levels[levelIndex].GetStreamer().AddSourcePosition(spawnPoint.Position);
+        });
 }
 
-void SampleApplication::OnStartLoading()
+void SampleApplication::ActivateLevel(int levelIndex)
 {
-    ShowLoadingScreen(true);
+    World* prevWorld = m_World;
+    int prevLevel = m_CurrentLevel;
+
+    LevelLoader& level = m_Levels[levelIndex];
+    level.Activate();
+
+    m_CurrentLevel = levelIndex;
+    m_World = level.GetWorld();
+    m_FailedLoadCount = 0;
+
+    // A run keeps counting ticks across level changes
+    if (m_Headless.IsEnabled())
+        m_Headless.Attach(m_World);
+
+    if (m_WorldRenderView[0])
+    {
+        m_WorldRenderView[0]->SetWorld(m_World);
+#ifdef SPLIT_SCREEN
+        m_WorldRenderView[1]->SetWorld(m_World);
+#endif
+    }
+
+    CreatePlayers();
+
+    if (prevWorld && prevLevel != levelIndex)
+        UnloadLevel(prevLevel);
 }
 
-void SampleApplication::OnUpdateLoading(float timeStep)
+void SampleApplication::UnloadLevel(int levelIndex)
 {
-    auto& resourceMngr = GameApplication::sGetResourceManager();
-    if (resourceMngr.IsAreaReady(m_Resources))
+    LevelLoader& level = m_Levels[levelIndex];
+    if (World* world = level.GetWorld())
     {
-        sGetStateMachine().MakeCurrent("State_Play");
+        level.StopStreaming();
+        level.Unload();
+        DestroyWorld(world);
     }
 }
 
+void SampleApplication::NextLevel()
+{
+    int nextLevel = m_CurrentLevel ^ 1;
+    if (!m_World || m_Levels[nextLevel].GetWorld())
+        return;
+
+    m_MapIndex = (m_MapIndex + 1) % HK_ARRAY_SIZE(MapRotation);
+
+    BeginLevel(nextLevel, m_MapIndex);
+}
+
 void SampleApplication::OnStartPlay()
 {
     ShowLoadingScreen(false);
 
+    if (m_Headless.IsEnabled())
+        m_Headless.Start(m_World);
+
 #if 0
     {
         auto& resourceMngr = GameApplication::GetResourceManager();
@@ -288,7 +502,9 @@ void SampleApplication::OnStartPlay()
 
 void SampleApplication::Pause()
 {
-    m_World->SetPaused(!m_World->GetTick().IsPaused);
+    // No world is active while the first level is loading
+    if (m_World)
+        m_World->SetPaused(!m_World->GetTick().IsPaused);
 }
 
 void SampleApplication::Quit()
@@ -298,6 +514,9 @@ void SampleApplication::Quit()
 
 void SampleApplication::ToggleWireframe()
 {
+    if (!m_WorldRenderView[0])
+        return;
+
     m_WorldRenderView[0]->bWireframe = !m_WorldRenderView[0]->bWireframe;
 #ifdef SPLIT_SCREEN
     m_WorldRenderView[1]->bWireframe = !m_WorldRenderView[1]->bWireframe;
@@ -306,6 +525,9 @@ void SampleApplication::ToggleWireframe()
 
 void SampleApplication::ShowLoadingScreen(bool show)
 {
+    if (!m_Desktop)
+        return;
+
     auto& resourceMngr = sGetResourceManager();
 
     if (show)
@@ -329,6 +551,10 @@ void SampleApplication::ShowLoadingScreen(bool show)
                     .WithTextureSize(texture->GetWidth(), texture->GetHeight())
                     .WithSize(Float2(texture->GetWidth(), texture->GetHeight())));
             }
+
+            m_LoadingScreen->AddWidget(UINewAssign(m_LoadingProgress, UIWidget)
+                .WithBackground(UINew(UISolidBrush, Color4::sWhite()))
+                .WithSize(Float2(0, LoadingProgressHeight)));
         }
 
         m_Desktop->SetFullscreenWidget(m_LoadingScreen);
@@ -340,6 +566,7 @@ void SampleApplication::ShowLoadingScreen(bool show)
         {
             m_Desktop->RemoveWidget(m_LoadingScreen);
             m_LoadingScreen = nullptr;
+            m_LoadingProgress = nullptr;
 
             resourceMngr.PurgeResourceData(m_LoadingTexture);
             m_LoadingTexture = {};
@@ -356,6 +583,10 @@ void SampleApplication::CreateResources()
 
     materialMngr.LoadLibrary("/Root/default/materials/default.mlib");
 
+    // Nothing is rendered in headless mode
+    if (!m_Headless.IsRenderEnabled())
+        return;
+
     // Procedurally generate a skybox image
     ImageStorage skyboxImage = sGetRenderBackend().GenerateAtmosphereSkybox(SKYBOX_IMPORT_TEXTURE_FORMAT_R11G11B10_FLOAT, 512, Float3(1, -1, -1).Normalized());
     // Convert image to resource
@@ -363,42 +594,20 @@ void SampleApplication::CreateResources()
     skybox->Upload();
     // Register the resource in the resource manager with the name "internal_skybox" so that it can be accessed by name from the materials.
     resourceMngr.CreateResourceWithData<TextureResource>("internal_skybox", std::move(skybox));
-
-    // List of resources used in scene
-    ResourceID sceneResources[] = {
-        resourceMngr.GetResource<MeshResource>("/Root/default/skybox.mesh"),
-        resourceMngr.GetResource<MeshResource>("/Root/default/box.mesh"),
-        resourceMngr.GetResource<MeshResource>("/Root/default/sphere.mesh"),
-        resourceMngr.GetResource<MeshResource>("/Root/default/capsule.mesh"),
-        resourceMngr.GetResource<MaterialResource>("/Root/default/materials/mg/default.mg"),
-        resourceMngr.GetResource<MaterialResource>("/Root/default/materials/mg/skybox.mg"),
-        //resourceMngr.GetResource<TextureResource>("/Root/dirt.png"),
-        resourceMngr.GetResource<TextureResource>("/Root/grid8.webp"),
-        resourceMngr.GetResource<TextureResource>("/Root/blank256.webp"),
-        resourceMngr.GetResource<TextureResource>("/Root/blank512.webp"),
-        resourceMngr.GetResource<TextureResource>("/Root/red512.png")
-    };
-
-    // Load resources asynchronously
-    m_Resources = resourceMngr.CreateResourceArea(sceneResources);
-    resourceMngr.LoadArea(m_Resources);
-
-    //resourceMngr.MainThread_WaitResourceArea(m_Resources);
 }
 
-void SampleApplication::CreateScene()
+void SampleApplication::PopulateScene(World* world, SceneConstructionQueue& queue)
 {
     auto& resourceMngr = GameApplication::sGetResourceManager();
     auto& materialMngr = GameApplication::sGetMaterialManager();
 
-    CreateSceneFromMap(m_World, "/Root/sample2.map"/*, "dirt"*/);
-
     Float3 playerSpawnPosition = Float3(0,8.25f,28);
     Quat playerSpawnRotation = Quat::sIdentity();
     Float3 playerSpawnPosition2 = Float3(0,8.25f,-28);
     Quat playerSpawnRotation2 = Quat::sRotationAroundNormal(Math::_PI, Float3(0,1,0));
 
     // Light
+    queue.Add([world]()
     {
         Float3 lightDirection = Float3(1, -1, -1).Normalized();
 
@@ -406,7 +615,7 @@ void SampleApplication::CreateScene()
         desc.IsDynamic = true;
 
         GameObject* object;
-        m_World->CreateObject(desc, object);
+        world->CreateObject(desc, object);
         object->SetDirection(lightDirection);
 
         DirectionalLightComponent* dirlight;
@@ -417,9 +626,10 @@ void SampleApplication::CreateScene()
         dirlight->SetShadowCascadeResolution(2048);
         dirlight->SetShadowCascadeOffset(0.0f);
         dirlight->SetShadowCascadeSplitLambda(0.8f);
-    }
+    });
 
     // Platform
+    queue.Add([world, &resourceMngr, &materialMngr]()
     {
         GameObject* object;
 
@@ -427,7 +637,7 @@ void SampleApplication::CreateScene()
         desc.Position = Float3(-8.75f, 6.5f, 0);
         desc.Scale = Float3(5.5f, 1, 4);
         desc.IsDynamic = true;
-        m_World->CreateObject(desc, object);
+        world->CreateObject(desc, object);
 
         DynamicBodyComponent* dynamicBody;
         object->CreateComponent(dynamicBody);
@@ -473,15 +683,16 @@ void SampleApplication::CreateScene()
         nodeMotion->Animation = animation;
         nodeMotion->Timer.LoopTime = 10;
         nodeMotion->NodeID = nodeID;
-    }
+    });
 
     // Teleporter
+    queue.Add([world, playerSpawnPosition, playerSpawnRotation, playerSpawnPosition2, playerSpawnRotation2]()
     {
         GameObjectDesc desc;
         desc.Position = Float3(0, -20, 0);
         desc.Scale = Float3(200, 20, 200);
         GameObject* object;
-        m_World->CreateObject(desc, object);
+        world->CreateObject(desc, object);
         TriggerComponent* phys;
         object->CreateComponent(phys);
         phys->CollisionLayer = CollisionLayer::Teleporter;
@@ -490,15 +701,16 @@ void SampleApplication::CreateScene()
         object->CreateComponent(teleport);
         teleport->TeleportPoints[0] = {playerSpawnPosition, playerSpawnRotation};
         teleport->TeleportPoints[1] = {playerSpawnPosition2, playerSpawnRotation2};
-    }
+    });
 
     // Jumpad
+    queue.Add([world]()
     {
         GameObjectDesc desc;
         desc.Position = Float3(0, 0.5f, 0);
         desc.Scale = Float3(4, 1, 4);
         GameObject* object;
-        m_World->CreateObject(desc, object);
+        world->CreateObject(desc, object);
         TriggerComponent* phys;
         object->CreateComponent(phys);
         phys->CollisionLayer = CollisionLayer::CharacterOnlyTrigger;
@@ -506,7 +718,7 @@ void SampleApplication::CreateScene()
         JumpadComponent* jumpad;
         object->CreateComponent(jumpad);
         jumpad->ThrowVelocity = Float3(0, 20, 0);//Float3(0, 30, 0);
-    }
+    });
 
     // Boxes
     {
@@ -520,35 +732,50 @@ void SampleApplication::CreateScene()
 
         for (int i = 0; i < HK_ARRAY_SIZE(positions); i++)
         {
-            GameObjectDesc desc;
-            desc.Position = positions[i];
-            desc.Rotation.FromAngles(0, Math::Radians(yaws[i]), 0);
-            desc.Scale = Float3(2);
-            desc.IsDynamic = true;
-            GameObject* object;
-            m_World->CreateObject(desc, object);
-            DynamicBodyComponent* phys;
-            object->CreateComponent(phys);
-            phys->Mass = 30;
-            object->CreateComponent<BoxCollider>();
-            DynamicMeshComponent* mesh;
-            object->CreateComponent(mesh);
-            mesh->SetMesh(resourceMngr.GetResource<MeshResource>("/Root/default/box.mesh"));
-            mesh->SetMaterial(materialMngr.TryGet("blank256"));
-            mesh->SetLocalBoundingBox({Float3(-0.5f),Float3(0.5f)});
+            Float3 position = positions[i];
+            float yaw = yaws[i];
+
+            queue.Add([world, &resourceMngr, &materialMngr, position, yaw]()
+            {
+                GameObjectDesc desc;
+                desc.Position = position;
+                desc.Rotation.FromAngles(0, Math::Radians(yaw), 0);
+                desc.Scale = Float3(2);
+                desc.IsDynamic = true;
+                GameObject* object;
+                world->CreateObject(desc, object);
+                DynamicBodyComponent* phys;
+                object->CreateComponent(phys);
+                phys->Mass = 30;
+                object->CreateComponent<BoxCollider>();
+                DynamicMeshComponent* mesh;
+                object->CreateComponent(mesh);
+                mesh->SetMesh(resourceMngr.GetResource<MeshResource>("/Root/default/box.mesh"));
+                mesh->SetMaterial(materialMngr.TryGet("blank256"));
+                mesh->SetLocalBoundingBox({Float3(-0.5f),Float3(0.5f)});
+            });
         }
     }
 
-    CreateElevator(Float3(7.5f,4.25f,-28));
-    CreateElevator(Float3(7.5f,4.25f,28));
-    CreateElevator(Float3(-7.5f,4.25f,-28));
-    CreateElevator(Float3(-7.5f,4.25f,28));
+    Float3 elevatorPositions[] = {
+        Float3(7.5f,4.25f,-28),
+        Float3(7.5f,4.25f,28),
+        Float3(-7.5f,4.25f,-28),
+        Float3(-7.5f,4.25f,28) };
+
+    for (Float3 const& position : elevatorPositions)
+        queue.Add([this, world, position]() { CreateElevator(world, position); });
+
+    // Enough projectiles for both players firing continuously
+    queue.Add([world]() { world->GetInterface<ProjectileInterface>().Prewarm(64); });
 
+    // Players are created when the level is activated
+    m_PlayerSpawnPoints.Clear();
     m_PlayerSpawnPoints.Add({playerSpawnPosition, playerSpawnRotation});
     m_PlayerSpawnPoints.Add({playerSpawnPosition2, playerSpawnRotation2});
 }
 
-void SampleApplication::CreateElevator(Float3 const& position)
+void SampleApplication::CreateElevator(World* world, Float3 const& position)
 {
     auto& resourceMngr = sGetResourceManager();
     auto& materialMngr = sGetMaterialManager();
@@ -559,7 +786,7 @@ void SampleApplication::CreateElevator(Float3 const& position)
     desc.Position = position;
     desc.Scale = Float3(3,0.5f,3.5f);
     desc.IsDynamic = true;
-    m_World->CreateObject(desc, object);
+    world->CreateObject(desc, object);
 
     DynamicBodyComponent* dynamicBody;
     object->CreateComponent(dynamicBody);
@@ -581,7 +808,7 @@ void SampleApplication::CreateElevator(Float3 const& position)
     desc.Position = position + Float3::sAxisY() * 0.5f;
     desc.Scale = Float3(2.5f,0.5f,3);
     desc.IsDynamic = false;
-    m_World->CreateObject(desc, triggerObject);
+    world->CreateObject(desc, triggerObject);
     TriggerComponent* trigger;
     triggerObject->CreateComponent(trigger);
     trigger->CollisionLayer = CollisionLayer::CharacterOnlyTrigger;
@@ -592,6 +819,57 @@ void SampleApplication::CreateElevator(Float3 const& position)
     activator->Elevator = elevatorHandle;
 }
 
+void SampleApplication::CreatePlayers()
+{
+    // Create players
+    GameObject* player = CreatePlayer(m_PlayerSpawnPoints[0].Position, m_PlayerSpawnPoints[0].Rotation, PlayerTeam::Blue);
+    GameObject* player2 = CreatePlayer(m_PlayerSpawnPoints[1].Position, m_PlayerSpawnPoints[1].Rotation, PlayerTeam::Red);
+
+    MapStreamer& streamer = m_Levels[m_CurrentLevel].GetStreamer();
+    streamer.AddSource(player->GetHandle());
+    streamer.AddSource(player2->GetHandle());
+
+    if (GameObject* camera = player->FindChildren(StringID("Camera")))
+    {
+        // Set camera for rendering
+        if (m_WorldRenderView[0])
+            m_WorldRenderView[0]->SetCamera(camera->GetComponentHandle<CameraComponent>());
+    
+        // Set audio listener
+        auto& audio = m_World->GetInterface<AudioInterface>();
+        audio.SetListener(camera->GetComponentHandle<AudioListenerComponent>());
+    }
+
+#ifdef SPLIT_SCREEN
+    if (GameObject* camera = player2->FindChildren(StringID("Camera")))
+    {
+        // Set camera for rendering
+        if (m_WorldRenderView[1])
+            m_WorldRenderView[1]->SetCamera(camera->GetComponentHandle<CameraComponent>());
+    }
+#endif
+    // Recording slots follow the controller order
+    auto& playerInput = m_World->GetInterface<PlayerInputInterface>();
+    playerInput.SetPlayer(0, player->GetHandle());
+    playerInput.SetPlayer(1, player2->GetHandle());
+    if (m_Recorder.IsRecording())
+        playerInput.SetRecorder(&m_Recorder);
+
+    // Replayed players don't take live input
+    if (m_IsReplaying)
+    {
+        playerInput.SetReplay(&m_Replay);
+        return;
+    }
+
+    // Bind input to the player
+    InputInterface& input = m_World->GetInterface<InputInterface>();
+    input.SetActive(true);
+    input.BindInput(player->GetComponentHandle<FirstPersonComponent>(), PlayerController::_2);    
+
+    input.BindInput(player2->GetComponentHandle<FirstPersonComponent>(), PlayerController::_1);
+}
+
 GameObject* SampleApplication::CreatePlayer(Float3 const& position, Quat const& rotation, PlayerTeam team)
 {
     auto& resourceMngr = sGetResourceManager();
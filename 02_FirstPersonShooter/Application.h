@@ -33,6 +33,9 @@ SOFTWARE.
 #include <Hork/GameApplication/GameApplication.h>
 #include <Hork/World/World.h>
 #include "Common/Components/PlayerTeam.h"
+#include "Common/LevelLoader.h"
+#include "Common/HeadlessRunner.h"
+#include "Common/InputRecording.h"
 
 HK_NAMESPACE_BEGIN
 
@@ -50,9 +53,16 @@ public:
     void Deinitialize();
 
 private:
+    void CreateUI();
     void CreateResources();
-    void CreateScene();
-    void CreateElevator(Float3 const& position);
+    World* CreateGameWorld();
+    void BeginLevel(int levelIndex, int mapIndex);
+    void ActivateLevel(int levelIndex);
+    void UnloadLevel(int levelIndex);
+    void NextLevel();
+    void PopulateScene(World* world, SceneConstructionQueue& queue);
+    void CreateElevator(World* world, Float3 const& position);
+    void CreatePlayers();
     GameObject* CreatePlayer(Float3 const& position, Quat const& rotation, PlayerTeam team);
     void Pause();
     void Quit();
@@ -62,16 +72,34 @@ private:
     void OnStartLoading();
     void OnUpdateLoading(float timeStep);
     void OnStartPlay();
-
-    UIDesktop* m_Desktop;
-    UIGrid* m_SplitView;
-    UIViewport* m_Viewports[2];
-    UIWidget* m_LoadingScreen;
-    ResourceAreaID m_Resources;
+    void OnUpdatePlay(float timeStep);
+
+    HeadlessRunner m_Headless;
+
+    // -record <file>, -replay <file> and -seed <number>
+    InputRecorder m_Recorder;
+    InputReplay m_Replay;
+    String m_RecordFile;
+    bool m_IsReplaying = false;
+    bool m_HasSeed = false;
+    uint32_t m_Seed = 0;
+
+    // Not created in headless mode
+    UIDesktop* m_Desktop{};
+    UIGrid* m_SplitView{};
+    UIViewport* m_Viewports[2]{};
+    UIWidget* m_LoadingScreen{};
+    UIWidget* m_LoadingProgress{};
     TextureHandle m_LoadingTexture;
 
     World* m_World{};
 
+    // The current level and the one preloaded in the background
+    LevelLoader m_Levels[2];
+    int m_CurrentLevel = 0;
+    int m_MapIndex = 0;
+    int m_FailedLoadCount = 0;
+
     struct SpawnPoint
     {
         Float3 Position;
@@ -38,6 +38,7 @@ SOFTWARE.
 #include "Common/Components/DoorComponent.h"
 #include "Common/Components/DoorActivatorComponent.h"
 #include "Common/Components/LightAnimator.h"
+#include "Common/Interfaces/PlayerInputInterface.h"
 #include "Common/CollisionLayer.h"
 
 #include <Hork/UI/UIViewport.h>
@@ -67,35 +68,45 @@ SOFTWARE.
 using namespace Hk;
 
 SampleApplication::SampleApplication(ArgumentPack const& args) :
-    GameApplication(args, "Hork Engine: Third Person")
-{}
+    GameApplication(args, "Hork Engine: Third Person"),
+    m_Headless(args)
+{
+    if (m_Headless.IsScripted())
+    {
+        m_Script.Generate(1, m_Headless.GetTickCount(), 1);
+    }
+}
 
 SampleApplication::~SampleApplication()
 {}
 
 void SampleApplication::Initialize()
 {
-    // Create UI
-    UIDesktop* desktop = UINew(UIDesktop);
-    GUIManager->AddDesktop(desktop);
-
-    // Add shortcuts
-    UIShortcutContainer* shortcuts = UINew(UIShortcutContainer);
-    shortcuts->AddShortcut(VirtualKey::Pause, {}, {this, &SampleApplication::Pause});
-    shortcuts->AddShortcut(VirtualKey::P, {}, {this, &SampleApplication::Pause});
-    shortcuts->AddShortcut(VirtualKey::Escape, {}, {this, &SampleApplication::Quit});
-    shortcuts->AddShortcut(VirtualKey::Y, {}, {this, &SampleApplication::ToggleWireframe});
-    desktop->SetShortcuts(shortcuts);
-
-    // Create viewport
-    UIViewport* mainViewport;
-    desktop->AddWidget(UINewAssign(mainViewport, UIViewport)
-        .WithPadding({0,0,0,0}));
-    desktop->SetFullscreenWidget(mainViewport);
-    desktop->SetFocusWidget(mainViewport);
-
-    // Hide mouse cursor
-    GUIManager->bCursorVisible = false;
+    // Headless runs only simulate the world unless frame building is measured too
+    UIViewport* mainViewport = nullptr;
+    if (m_Headless.IsRenderEnabled())
+    {
+        // Create UI
+        UIDesktop* desktop = UINew(UIDesktop);
+        GUIManager->AddDesktop(desktop);
+
+        // Add shortcuts
+        UIShortcutContainer* shortcuts = UINew(UIShortcutContainer);
+        shortcuts->AddShortcut(VirtualKey::Pause, {}, {this, &SampleApplication::Pause});
+        shortcuts->AddShortcut(VirtualKey::P, {}, {this, &SampleApplication::Pause});
+        shortcuts->AddShortcut(VirtualKey::Escape, {}, {this, &SampleApplication::Quit});
+        shortcuts->AddShortcut(VirtualKey::Y, {}, {this, &SampleApplication::ToggleWireframe});
+        desktop->SetShortcuts(shortcuts);
+
+        // Create viewport
+        desktop->AddWidget(UINewAssign(mainViewport, UIViewport)
+            .WithPadding({0,0,0,0}));
+        desktop->SetFullscreenWidget(mainViewport);
+        desktop->SetFocusWidget(mainViewport);
+
+        // Hide mouse cursor
+        GUIManager->bCursorVisible = false;
+    }
 
     // Set input mappings
     Ref<InputMappings> inputMappings = MakeRef<InputMappings>();
@@ -135,12 +146,15 @@ void SampleApplication::Initialize()
     m_World->GetInterface<PhysicsInterface>().SetCollisionFilter(CollisionLayer::CreateFilter());
 
     // Set rendering parameters
-    m_WorldRenderView = MakeRef<WorldRenderView>();
-    m_WorldRenderView->SetWorld(m_World);
-    m_WorldRenderView->bClearBackground = true;
-    m_WorldRenderView->BackgroundColor = Color4::sBlack();
-    m_WorldRenderView->bDrawDebug = true;
-    mainViewport->SetWorldRenderView(m_WorldRenderView);
+    if (mainViewport)
+    {
+        m_WorldRenderView = MakeRef<WorldRenderView>();
+        m_WorldRenderView->SetWorld(m_World);
+        m_WorldRenderView->bClearBackground = true;
+        m_WorldRenderView->BackgroundColor = Color4::sBlack();
+        m_WorldRenderView->bDrawDebug = true;
+        mainViewport->SetWorldRenderView(m_WorldRenderView);
+    }
 
     // Create scene
     CreateScene();
@@ -151,17 +165,33 @@ void SampleApplication::Initialize()
     if (GameObject* camera = player->FindChildrenRecursive(StringID("Camera")))
     {
         // Set camera for rendering
-        m_WorldRenderView->SetCamera(camera->GetComponentHandle<CameraComponent>());
+        if (m_WorldRenderView)
+            m_WorldRenderView->SetCamera(camera->GetComponentHandle<CameraComponent>());
     
         // Set audio listener
         auto& audio = m_World->GetInterface<AudioInterface>();
         audio.SetListener(camera->GetComponentHandle<AudioListenerComponent>());
     }
 
-    // Bind input to the player
-    InputInterface& input = m_World->GetInterface<InputInterface>();
-    input.SetActive(true);
-    input.BindInput(player->GetComponentHandle<ThirdPersonComponent>(), PlayerController::_1);
+    if (m_Headless.IsScripted())
+    {
+        auto& playerInput = m_World->GetInterface<PlayerInputInterface>();
+        playerInput.SetPlayer(0, player->GetHandle());
+        playerInput.SetReplay(&m_Script);
+    }
+    else
+    {
+        // Bind input to the player
+        InputInterface& input = m_World->GetInterface<InputInterface>();
+        input.SetActive(true);
+        input.BindInput(player->GetComponentHandle<ThirdPersonComponent>(), PlayerController::_1);
+    }
+
+    sGetStateMachine().Bind("State_Play", this, {}, {}, &SampleApplication::OnUpdate);
+    sGetStateMachine().MakeCurrent("State_Play");
+
+    if (m_Headless.IsEnabled())
+        m_Headless.Start(m_World);
 }
 
 void SampleApplication::Deinitialize()
@@ -184,6 +214,12 @@ void SampleApplication::ToggleWireframe()
     m_WorldRenderView->bWireframe = !m_WorldRenderView->bWireframe;
 }
 
+void SampleApplication::OnUpdate(float timeStep)
+{
+    if (m_Headless.Update())
+        PostTerminateEvent();
+}
+
 void SampleApplication::CreateResources()
 {
     auto& resourceMngr = sGetResourceManager();
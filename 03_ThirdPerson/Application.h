@@ -33,6 +33,8 @@ SOFTWARE.
 #include <Hork/GameApplication/GameApplication.h>
 #include <Hork/Resources/ResourceManager.h>
 #include <Hork/World/Modules/Render/Components/CameraComponent.h>
+#include "Common/HeadlessRunner.h"
+#include "Common/InputRecording.h"
 
 HK_NAMESPACE_BEGIN
 
@@ -52,6 +54,12 @@ private:
     void Pause();
     void Quit();
     void ToggleWireframe();
+    void OnUpdate(float timeStep);
+
+    HeadlessRunner m_Headless;
+
+    // Scripted input of the player in benchmark runs
+    InputReplay m_Script;
 
     World* m_World{};
 
@@ -118,7 +118,8 @@ public:
 };
 
 SampleApplication::SampleApplication(ArgumentPack const& args) :
-    GameApplication(args, "Hork Engine: Render To Texture")
+    GameApplication(args, "Hork Engine: Render To Texture"),
+    m_Headless(args)
 {}
 
 SampleApplication::~SampleApplication()
@@ -241,12 +242,18 @@ void SampleApplication::OnStartPlay()
 
     RenderInterface& render = m_World->GetInterface<RenderInterface>();
     render.SetAmbient(0.001f);
+
+    if (m_Headless.IsEnabled())
+        m_Headless.Start(m_World);
 }
 
 void SampleApplication::OnUpdate(float timeStep)
 {
     // We must register the render view in a loop for offscreen rendering
     sGetFrameLoop().RegisterView(m_OffscreenRenderView);
+
+    if (m_Headless.Update())
+        PostTerminateEvent();
 }
 
 void SampleApplication::Pause()
@@ -33,6 +33,7 @@ SOFTWARE.
 #include <Hork/GameApplication/GameApplication.h>
 #include <Hork/Resources/ResourceManager.h>
 #include <Hork/World/Modules/Render/Components/CameraComponent.h>
+#include "Common/HeadlessRunner.h"
 
 HK_NAMESPACE_BEGIN
 
@@ -55,6 +56,9 @@ private:
     void OnStartPlay();
     void OnUpdate(float timeStep);
 
+    // The sample is about rendering, so headless runs keep the render views and only time the frames
+    HeadlessRunner m_Headless;
+
     World* m_World{};
 
     Ref<WorldRenderView> m_WorldRenderView;
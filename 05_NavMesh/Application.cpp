@@ -278,7 +278,8 @@ private:
 };
 
 SampleApplication::SampleApplication(ArgumentPack const& args) :
-    GameApplication(args, "Hork Engine: Nav Mesh")
+    GameApplication(args, "Hork Engine: Nav Mesh"),
+    m_Headless(args)
 {}
 
 SampleApplication::~SampleApplication()
@@ -359,6 +360,12 @@ void SampleApplication::Initialize()
     sGetCommandProcessor().Add("com_DrawNavMesh 1\n");
     //sGetCommandProcessor().Add("com_DrawNavMeshAreas 1\n");    
     sGetCommandProcessor().Add("com_DrawOffMeshLinks 1\n");
+
+    sGetStateMachine().Bind("State_Play", this, {}, {}, &SampleApplication::OnUpdate);
+    sGetStateMachine().MakeCurrent("State_Play");
+
+    if (m_Headless.IsEnabled())
+        m_Headless.Start(m_World);
 }
 
 void SampleApplication::Deinitialize()
@@ -381,6 +388,12 @@ void SampleApplication::ToggleWireframe()
     m_WorldRenderView->bWireframe = !m_WorldRenderView->bWireframe;
 }
 
+void SampleApplication::OnUpdate(float timeStep)
+{
+    if (m_Headless.Update())
+        PostTerminateEvent();
+}
+
 void SampleApplication::CreateResources()
 {
     auto& resourceMngr = sGetResourceManager();
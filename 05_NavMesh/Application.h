@@ -33,6 +33,7 @@ SOFTWARE.
 #include <Hork/GameApplication/GameApplication.h>
 #include <Hork/Resources/ResourceManager.h>
 #include <Hork/World/Modules/Render/Components/CameraComponent.h>
+#include "Common/HeadlessRunner.h"
 
 HK_NAMESPACE_BEGIN
 
@@ -52,6 +53,10 @@ private:
     void Pause();
     void Quit();
     void ToggleWireframe();
+    void OnUpdate(float timeStep);
+
+    // Headless runs keep the UI and the render view and only time the frames
+    HeadlessRunner m_Headless;
 
     World* m_World{};
 
@@ -58,7 +58,8 @@ SOFTWARE.
 using namespace Hk;
 
 SampleApplication::SampleApplication(ArgumentPack const& args) :
-    GameApplication(args, "Hork Engine: Ies Profiles")
+    GameApplication(args, "Hork Engine: Ies Profiles"),
+    m_Headless(args)
 {}
 
 SampleApplication::~SampleApplication()
@@ -135,7 +136,7 @@ void SampleApplication::Initialize()
     auto& stateMachine = sGetStateMachine();
 
     stateMachine.Bind("State_Loading", this, &SampleApplication::OnStartLoading, {}, &SampleApplication::OnUpdateLoading);
-    stateMachine.Bind("State_Play", this, &SampleApplication::OnStartPlay, {}, {});
+    stateMachine.Bind("State_Play", this, &SampleApplication::OnStartPlay, {}, &SampleApplication::OnUpdatePlay);
 
     stateMachine.MakeCurrent("State_Loading");
 }
@@ -183,6 +184,15 @@ void SampleApplication::OnStartPlay()
     InputInterface& input = m_World->GetInterface<InputInterface>();
     input.SetActive(true);
     input.BindInput(player->GetComponentHandle<FirstPersonComponent>(), PlayerController::_1);   
+
+    if (m_Headless.IsEnabled())
+        m_Headless.Start(m_World);
+}
+
+void SampleApplication::OnUpdatePlay(float timeStep)
+{
+    if (m_Headless.Update())
+        PostTerminateEvent();
 }
 
 void SampleApplication::Pause()
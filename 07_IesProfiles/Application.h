@@ -32,6 +32,7 @@ SOFTWARE.
 
 #include <Hork/GameApplication/GameApplication.h>
 #include <Hork/World/World.h>
+#include "Common/HeadlessRunner.h"
 
 HK_NAMESPACE_BEGIN
 
@@ -61,12 +62,17 @@ private:
     void OnStartLoading();
     void OnUpdateLoading(float timeStep);
     void OnStartPlay();
+    void OnUpdatePlay(float timeStep);
 
     UIDesktop* m_Desktop;
     UIViewport* m_Viewport;
     UIWidget* m_LoadingScreen;
     ResourceAreaID m_Resources;
     TextureHandle m_LoadingTexture;
+
+    // The sample is about lighting, so headless runs keep the render view and only time the frames
+    HeadlessRunner m_Headless;
+
     World* m_World{};
     Ref<WorldRenderView> m_WorldRenderView;
 };
@@ -53,6 +53,7 @@ using namespace Hk;
 
 SampleApplication::SampleApplication(ArgumentPack const& args) :
     GameApplication(args, "Hork Engine: Movie Player"),
+    m_Headless(args),
     m_Cinematic("cinematic")
 {}
 
@@ -137,10 +138,14 @@ void SampleApplication::Initialize()
 
     stateMachine.MakeCurrent("State_Intro");
 
-    sGetCommandProcessor().Add("com_ShowStat 1\n");
-    sGetCommandProcessor().Add("com_ShowFPS 1\n");
-    sGetCommandProcessor().Add("com_MaxFPS 0\n");
-    sGetCommandProcessor().Add("rt_SwapInterval 1\n");
+    // Headless runs set the frame rate limit themselves
+    if (!m_Headless.IsEnabled())
+    {
+        sGetCommandProcessor().Add("com_ShowStat 1\n");
+        sGetCommandProcessor().Add("com_ShowFPS 1\n");
+        sGetCommandProcessor().Add("com_MaxFPS 0\n");
+        sGetCommandProcessor().Add("rt_SwapInterval 1\n");
+    }
 }
 
 void SampleApplication::Deinitialize()
@@ -168,6 +173,9 @@ void SampleApplication::OnUpdate(float timeStep)
 {
     if (!m_World->GetTick().IsPaused)
         m_Cinematic.Tick(timeStep);
+
+    if (m_Headless.Update())
+        PostTerminateEvent();
 }
 
 void SampleApplication::OnVideoFrameUpdated(uint8_t const* data, uint32_t width, uint32_t height)
@@ -214,6 +222,9 @@ void SampleApplication::OnStartPlay()
     InputInterface& input = m_World->GetInterface<InputInterface>();
     input.SetActive(true);
     input.BindInput(player->GetComponentHandle<FirstPersonComponent>(), PlayerController::_1);   
+
+    if (m_Headless.IsEnabled())
+        m_Headless.Start(m_World);
 }
 
 void SampleApplication::Pause()
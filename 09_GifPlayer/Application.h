@@ -33,6 +33,7 @@ SOFTWARE.
 #include <Hork/GameApplication/GameApplication.h>
 #include <Hork/Cinematic/GifPlayer.h>
 #include <Hork/World/World.h>
+#include "Common/HeadlessRunner.h"
 
 HK_NAMESPACE_BEGIN
 
@@ -67,6 +68,10 @@ private:
     UIWidget* m_IntroWidget;
     ResourceAreaID m_Resources;
     TextureHandle m_LoadingTexture;
+
+    // Headless runs keep the UI, so the animation is still decoded and uploaded, and only time the frames
+    HeadlessRunner m_Headless;
+
     World* m_World{};
     Ref<WorldRenderView> m_WorldRenderView;
     GifPlayer m_GifPlayer;
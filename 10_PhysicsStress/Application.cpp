@@ -0,0 +1,415 @@
+﻿/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Physics stress test. Drops dynamic bodies into the room of sample7.map, drives kinematic movers
+// through them and scatters trigger volumes over the floor. Every simulated second the physics step
+// time, the estimated broadphase pairs and the contact counts are written to the log.
+//
+//     -bodies N            dynamic bodies (default 2000)
+//     -movers N            kinematic movers (default 16)
+//     -triggers N          trigger volumes (default 32)
+//     -ramp N              add N bodies every second until all are spawned, to see where scaling breaks
+//     -nocontacts          don't dispatch contact events, so the step time has no callback overhead
+//     -csv FILE            write the samples to a file on exit
+//
+// Runs windowed or with the HeadlessRunner options.
+
+#include "Application.h"
+#include "PhysicsStressInterface.h"
+
+#include "Common/MapParser/Utils.h"
+#include "Common/CollisionLayer.h"
+#include "Common/TickStats.h"
+
+#include <Hork/UI/UIViewport.h>
+
+#include <Hork/World/Modules/Physics/CollisionFilter.h>
+#include <Hork/World/Modules/Physics/Components/DynamicBodyComponent.h>
+#include <Hork/World/Modules/Physics/Components/TriggerComponent.h>
+
+#include <Hork/World/Modules/Render/Components/CameraComponent.h>
+#include <Hork/World/Modules/Render/Components/PunctualLightComponent.h>
+#include <Hork/World/Modules/Render/Components/MeshComponent.h>
+#include <Hork/World/Modules/Render/RenderInterface.h>
+
+#include <cstdlib>
+
+using namespace Hk;
+
+namespace
+{
+    // Inside of the room in sample7.map
+    const float ArenaHalfSize = 13;
+    const float ArenaTop = 6;
+
+    const float BodySize = 0.5f;
+    const float BodySpacing = 0.75f;
+    // Bounding sphere of a body, for the pair estimate
+    const float BodyRadius = 0.44f;
+
+    const int BodiesPerRow = int(2 * ArenaHalfSize / BodySpacing) + 1;
+    const int BodiesPerLayer = BodiesPerRow * BodiesPerRow;
+    const int BodyLayers = int((ArenaTop - 1) / BodySpacing) + 1;
+
+    int GetArgument(ArgumentPack const& args, const char* name, int defaultValue)
+    {
+        int i = args.Find(name);
+        if (i != -1 && i + 1 < args.Size())
+            return Math::Max(std::atoi(args.At(i + 1)), 0);
+        return defaultValue;
+    }
+}
+
+SampleApplication::SampleApplication(ArgumentPack const& args) :
+    GameApplication(args, "Hork Engine: Physics Stress"),
+    m_Headless(args)
+{
+    m_BodyCount = GetArgument(args, "-bodies", m_BodyCount);
+    m_MoverCount = GetArgument(args, "-movers", m_MoverCount);
+    m_TriggerCount = GetArgument(args, "-triggers", m_TriggerCount);
+    m_BodiesPerSecond = GetArgument(args, "-ramp", m_BodiesPerSecond);
+    m_CountContacts = args.Find("-nocontacts") == -1;
+
+    int i = args.Find("-csv");
+    if (i != -1 && i + 1 < args.Size())
+        m_CsvFile = args.At(i + 1);
+}
+
+SampleApplication::~SampleApplication()
+{}
+
+void SampleApplication::Initialize()
+{
+    UIViewport* mainViewport = nullptr;
+    if (m_Headless.IsRenderEnabled())
+    {
+        // Create UI
+        UIDesktop* desktop = UINew(UIDesktop);
+        GUIManager->AddDesktop(desktop);
+
+        // Add shortcuts
+        UIShortcutContainer* shortcuts = UINew(UIShortcutContainer);
+        shortcuts->AddShortcut(VirtualKey::Pause, {}, {this, &SampleApplication::Pause});
+        shortcuts->AddShortcut(VirtualKey::P, {}, {this, &SampleApplication::Pause});
+        shortcuts->AddShortcut(VirtualKey::Escape, {}, {this, &SampleApplication::Quit});
+        shortcuts->AddShortcut(VirtualKey::Y, {}, {this, &SampleApplication::ToggleWireframe});
+        desktop->SetShortcuts(shortcuts);
+
+        // Create viewport
+        desktop->AddWidget(UINewAssign(mainViewport, UIViewport)
+            .WithPadding({0,0,0,0}));
+        desktop->SetFullscreenWidget(mainViewport);
+        desktop->SetFocusWidget(mainViewport);
+
+        // Hide mouse cursor
+        GUIManager->bCursorVisible = false;
+    }
+
+    TickStats::sGet().RegisterCommands();
+
+    // Create game resources
+    CreateResources();
+
+    // Create game world
+    m_World = CreateWorld();
+
+    // Setup world collision
+    m_World->GetInterface<PhysicsInterface>().SetCollisionFilter(CollisionLayer::CreateFilter());
+
+    // Set rendering parameters
+    if (mainViewport)
+    {
+        m_WorldRenderView = MakeRef<WorldRenderView>();
+        m_WorldRenderView->SetWorld(m_World);
+        m_WorldRenderView->bClearBackground = true;
+        m_WorldRenderView->BackgroundColor = Color4::sBlack();
+        mainViewport->SetWorldRenderView(m_WorldRenderView);
+    }
+
+    // Create scene
+    CreateScene();
+
+    LOG("Physics stress: {} bodies{}, {} movers, {} triggers{}\n",
+        m_BodyCount, m_BodiesPerSecond ? " ramped" : "", m_MoverCount, m_TriggerCount, m_CountContacts ? "" : ", no contact events");
+
+    sGetStateMachine().Bind("State_Play", this, {}, {}, &SampleApplication::OnUpdate);
+    sGetStateMachine().MakeCurrent("State_Play");
+
+    if (m_Headless.IsEnabled())
+        m_Headless.Start(m_World);
+}
+
+void SampleApplication::Deinitialize()
+{
+    if (!m_CsvFile.IsEmpty())
+        m_World->GetInterface<PhysicsStressInterface>().WriteCsv(m_CsvFile);
+
+    DestroyWorld(m_World);
+}
+
+void SampleApplication::Pause()
+{
+    m_World->SetPaused(!m_World->GetTick().IsPaused);
+}
+
+void SampleApplication::Quit()
+{
+    PostTerminateEvent();
+}
+
+void SampleApplication::ToggleWireframe()
+{
+    m_WorldRenderView->bWireframe = !m_WorldRenderView->bWireframe;
+}
+
+void SampleApplication::OnUpdate(float timeStep)
+{
+    TickStats::sGet().NextFrame();
+
+    // The next batch of bodies is dropped after each sample
+    int sampleCount = m_World->GetInterface<PhysicsStressInterface>().GetSamples().Size();
+    if (sampleCount != m_SampleCount)
+    {
+        m_SampleCount = sampleCount;
+        if (m_SpawnedBodies < m_BodyCount)
+            SpawnBodies(m_BodyCount - m_SpawnedBodies);
+    }
+
+    if (m_Headless.Update())
+        PostTerminateEvent();
+}
+
+void SampleApplication::CreateResources()
+{
+    auto& resourceMngr = sGetResourceManager();
+    auto& materialMngr = sGetMaterialManager();
+
+    materialMngr.LoadLibrary("/Root/default/materials/default.mlib");
+
+    // List of resources used in scene
+    ResourceID sceneResources[] = {
+        resourceMngr.GetResource<MeshResource>("/Root/default/box.mesh"),
+        resourceMngr.GetResource<MeshResource>("/Root/default/sphere.mesh"),
+        resourceMngr.GetResource<MaterialResource>("/Root/default/materials/mg/default.mg"),
+        resourceMngr.GetResource<TextureResource>("/Root/grid8.webp"),
+        resourceMngr.GetResource<TextureResource>("/Root/blank256.webp"),
+        resourceMngr.GetResource<TextureResource>("/Root/gray.png")
+    };
+
+    // Load resources asynchronously
+    ResourceAreaID resources = resourceMngr.CreateResourceArea(sceneResources);
+    resourceMngr.LoadArea(resources);
+
+    // Wait for the resources to load
+    resourceMngr.MainThread_WaitResourceArea(resources);
+}
+
+void SampleApplication::CreateScene()
+{
+    CreateSceneFromMap(m_World, "/Root/sample7.map", "gray");
+
+    // Light
+    {
+        GameObjectDesc desc;
+        desc.Name.FromString("Light");
+        desc.Position = Float3(0, 6.5f, 0);
+        desc.IsDynamic = true;
+        GameObject* object;
+        m_World->CreateObject(desc, object);
+
+        PunctualLightComponent* light;
+        object->CreateComponent(light);
+        light->SetRadius(25);
+        light->SetLumens(3000);
+
+        m_World->GetInterface<RenderInterface>().SetAmbient(0.05f);
+    }
+
+    if (m_WorldRenderView)
+        CreateCamera();
+
+    SpawnMovers();
+    SpawnTriggers();
+    SpawnBodies(m_BodyCount);
+}
+
+void SampleApplication::CreateCamera()
+{
+    GameObjectDesc desc;
+    desc.Name.FromString("Camera");
+    desc.Position = Float3(0, 5.5f, ArenaHalfSize);
+    desc.Rotation.FromAngles(Math::Radians(-25.0f), 0, 0);
+    desc.IsDynamic = true;
+    GameObject* camera;
+    m_World->CreateObject(desc, camera);
+
+    CameraComponent* cameraComponent;
+    camera->CreateComponent(cameraComponent);
+    cameraComponent->SetFovY(90);
+
+    m_WorldRenderView->SetCamera(camera->GetComponentHandle<CameraComponent>());
+}
+
+void SampleApplication::SpawnBodies(int count)
+{
+    auto& resourceMngr = sGetResourceManager();
+    auto& materialMngr = sGetMaterialManager();
+    auto& stress = m_World->GetInterface<PhysicsStressInterface>();
+
+    // One batch fills the layers from the top down, so it doesn't spawn inside the bodies that already fell
+    count = Math::Min(count, m_BodiesPerSecond ? m_BodiesPerSecond : BodiesPerLayer * BodyLayers);
+
+    for (int i = 0; i < count; ++i)
+    {
+        int cell = i % BodiesPerLayer;
+        int layer = i / BodiesPerLayer;
+        int index = m_SpawnedBodies + i;
+        bool isBox = (index & 1) == 0;
+
+        GameObjectDesc desc;
+        desc.Position = Float3(-ArenaHalfSize + (cell % BodiesPerRow) * BodySpacing,
+                               ArenaTop - layer * BodySpacing,
+                               -ArenaHalfSize + (cell / BodiesPerRow) * BodySpacing);
+        desc.Rotation.FromAngles(0, Math::Radians(float(index * 37 % 90)), 0);
+        desc.Scale = Float3(BodySize);
+        desc.IsDynamic = true;
+        GameObject* object;
+        m_World->CreateObject(desc, object);
+
+        DynamicBodyComponent* phys;
+        object->CreateComponent(phys);
+        phys->Mass = 10;
+        phys->DispatchContactEvents = m_CountContacts;
+
+        if (isBox)
+        {
+            object->CreateComponent<BoxCollider>();
+        }
+        else
+        {
+            SphereCollider* collider;
+            object->CreateComponent(collider);
+            collider->Radius = 0.5f;
+        }
+
+        // Headless runs measure the physics only
+        if (m_WorldRenderView)
+        {
+            DynamicMeshComponent* mesh;
+            object->CreateComponent(mesh);
+            mesh->SetMesh(resourceMngr.GetResource<MeshResource>(isBox ? "/Root/default/box.mesh" : "/Root/default/sphere.mesh"));
+            mesh->SetMaterial(materialMngr.TryGet("blank256"));
+            mesh->SetLocalBoundingBox({Float3(-0.5f),Float3(0.5f)});
+        }
+
+        object->CreateComponent<StressBodyComponent>();
+
+        stress.AddBody(object, BodyRadius);
+    }
+
+    m_SpawnedBodies += count;
+}
+
+void SampleApplication::SpawnMovers()
+{
+    auto& resourceMngr = sGetResourceManager();
+    auto& materialMngr = sGetMaterialManager();
+    auto& stress = m_World->GetInterface<PhysicsStressInterface>();
+
+    const float MoveSpeed = 3;
+
+    for (int i = 0; i < m_MoverCount; ++i)
+    {
+        // Four concentric circles, movers of one circle spread evenly
+        int circle = i % 4;
+        int circleMoverCount = (m_MoverCount - circle + 3) / 4;
+        float circleRadius = 2 + circle * 3.0f;
+        float angle = (i / 4) * Math::_PI * 2 / circleMoverCount;
+        Float3 center(0, 0.5f, 0);
+
+        float s, c;
+        Math::SinCos(angle, s, c);
+
+        GameObjectDesc desc;
+        desc.Position = center + Float3(c, 0, s) * circleRadius;
+        desc.Scale = Float3(1.5f, 1, 0.5f);
+        desc.IsDynamic = true;
+        GameObject* object;
+        m_World->CreateObject(desc, object);
+
+        DynamicBodyComponent* phys;
+        object->CreateComponent(phys);
+        phys->SetKinematic(true);
+        object->CreateComponent<BoxCollider>();
+
+        if (m_WorldRenderView)
+        {
+            DynamicMeshComponent* mesh;
+            object->CreateComponent(mesh);
+            mesh->SetMesh(resourceMngr.GetResource<MeshResource>("/Root/default/box.mesh"));
+            mesh->SetMaterial(materialMngr.TryGet("grid8"));
+            mesh->SetLocalBoundingBox({Float3(-0.5f),Float3(0.5f)});
+        }
+
+        stress.AddMover(object, center, circleRadius, angle, MoveSpeed, 0.94f);
+    }
+}
+
+void SampleApplication::SpawnTriggers()
+{
+    auto& stress = m_World->GetInterface<PhysicsStressInterface>();
+
+    const float TriggerSize = 2;
+
+    int perRow = Math::Max(int(Math::Ceil(Math::Sqrt(float(m_TriggerCount)))), 1);
+    float spacing = 2 * ArenaHalfSize / perRow;
+
+    for (int i = 0; i < m_TriggerCount; ++i)
+    {
+        GameObjectDesc desc;
+        desc.Position = Float3(-ArenaHalfSize + (i % perRow + 0.5f) * spacing,
+                               TriggerSize * 0.5f,
+                               -ArenaHalfSize + (i / perRow + 0.5f) * spacing);
+        desc.Scale = Float3(TriggerSize);
+        GameObject* object;
+        m_World->CreateObject(desc, object);
+
+        TriggerComponent* trigger;
+        object->CreateComponent(trigger);
+        trigger->CollisionLayer = CollisionLayer::Default;
+        object->CreateComponent<BoxCollider>();
+        object->CreateComponent<StressTriggerComponent>();
+
+        stress.AddTrigger(object, TriggerSize * 0.87f);
+    }
+}
+
+using ApplicationClass = SampleApplication;
+#include "Common/EntryPoint.h"
@@ -0,0 +1,78 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/GameApplication/GameApplication.h>
+#include <Hork/Resources/ResourceManager.h>
+#include "Common/HeadlessRunner.h"
+
+HK_NAMESPACE_BEGIN
+
+class SampleApplication final : public GameApplication
+{
+public:
+    SampleApplication(ArgumentPack const& args);
+    ~SampleApplication();
+
+    void Initialize();
+    void Deinitialize();
+
+private:
+    void CreateResources();
+    void CreateScene();
+    void CreateCamera();
+    void SpawnBodies(int count);
+    void SpawnMovers();
+    void SpawnTriggers();
+    void Pause();
+    void Quit();
+    void ToggleWireframe();
+    void OnUpdate(float timeStep);
+
+    HeadlessRunner m_Headless;
+
+    // Stress settings from the command line
+    int m_BodyCount = 2000;
+    int m_MoverCount = 16;
+    int m_TriggerCount = 32;
+    int m_BodiesPerSecond = 0;
+    bool m_CountContacts = true;
+    String m_CsvFile;
+
+    int m_SpawnedBodies = 0;
+    int m_SampleCount = 0;
+
+    World* m_World{};
+
+    Ref<WorldRenderView> m_WorldRenderView;
+};
+
+HK_NAMESPACE_END
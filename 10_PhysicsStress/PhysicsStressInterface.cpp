@@ -0,0 +1,235 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "PhysicsStressInterface.h"
+#include "Common/TraceProfiler.h"
+#include "Common/Interfaces/MoverInterface.h"
+#include "Common/Interfaces/ParallelTickInterface.h"
+#include "Common/Interfaces/PlayerInputInterface.h"
+#include "Common/Interfaces/ProjectileInterface.h"
+#include "Common/Interfaces/TickCounterInterface.h"
+#include "Common/Interfaces/TimerInterface.h"
+
+#include <Hork/Core/Logger.h>
+
+#include <algorithm>
+#include <cstdio>
+
+HK_NAMESPACE_BEGIN
+
+PhysicsStressInterface::PhysicsStressInterface()
+{}
+
+void PhysicsStressInterface::Initialize()
+{
+    m_StepEntry = &TickStats::sGet().Register("PhysicsInterface", "PhysicsStep");
+
+    // The step is timed from the end of this function, so it runs after every other FixedUpdate function
+    {
+        TickFunction f;
+        f.Desc.Name.FromString("Stress Movers");
+        f.Desc.AddPrerequisiteInterface<ParallelTickInterface>();
+        f.Desc.AddPrerequisiteInterface<MoverInterface>();
+        f.Desc.AddPrerequisiteInterface<TimerInterface>();
+        f.Desc.AddPrerequisiteInterface<ProjectileInterface>();
+        f.Desc.AddPrerequisiteInterface<PlayerInputInterface>();
+        f.Desc.AddPrerequisiteInterface<TickCounterInterface>();
+        f.Group = TickGroup::FixedUpdate;
+        f.OwnerTypeID = GetInterfaceTypeID() | (1 << 31);
+        f.Delegate.Bind(this, &PhysicsStressInterface::FixedUpdate);
+        RegisterTickFunction(f);
+    }
+    {
+        TickFunction f;
+        f.Desc.Name.FromString("Stress Metrics");
+        f.Desc.AddPrerequisiteInterface<PhysicsInterface>();
+        f.Group = TickGroup::PhysicsUpdate;
+        f.OwnerTypeID = GetInterfaceTypeID() | (1 << 31);
+        f.Delegate.Bind(this, &PhysicsStressInterface::PostPhysicsUpdate);
+        RegisterTickFunction(f);
+    }
+}
+
+void PhysicsStressInterface::Deinitialize()
+{
+    m_Objects.Clear();
+    m_Movers.Clear();
+    m_BodyCount = 0;
+    m_Bounds.Clear();
+}
+
+void PhysicsStressInterface::AddBody(GameObject* object, float radius)
+{
+    m_Objects.Add({object->GetHandle(), radius});
+    ++m_BodyCount;
+}
+
+void PhysicsStressInterface::AddMover(GameObject* object, Float3 const& center, float circleRadius, float angle, float speed, float radius)
+{
+    Mover& mover = m_Movers.EmplaceBack();
+    mover.Handle = object->GetHandle();
+    mover.Center = center;
+    mover.CircleRadius = circleRadius;
+    mover.Angle = angle;
+    mover.AngularSpeed = speed / circleRadius;
+
+    m_Objects.Add({object->GetHandle(), radius});
+}
+
+void PhysicsStressInterface::AddTrigger(GameObject* object, float radius)
+{
+    m_Objects.Add({object->GetHandle(), radius});
+}
+
+void PhysicsStressInterface::FixedUpdate()
+{
+    {
+        HK_TRACE_ZONE("FixedUpdate/StressMovers");
+        HK_TICK_COST("PhysicsStressInterface", "FixedUpdate");
+
+        float timeStep = GetWorld()->GetTick().FixedTimeStep;
+
+        World* world = GetWorld();
+        for (Mover& mover : m_Movers)
+        {
+            mover.Angle += mover.AngularSpeed * timeStep;
+            if (mover.Angle > Math::_PI * 2)
+                mover.Angle -= Math::_PI * 2;
+
+            if (GameObject* object = world->GetObject(mover.Handle))
+            {
+                float s, c;
+                Math::SinCos(mover.Angle, s, c);
+                object->SetPosition(mover.Center + Float3(c, 0, s) * mover.CircleRadius);
+            }
+        }
+    }
+
+    m_StepStart = Clock::now();
+    m_StepStartCycles = TickStats::sReadCycles();
+}
+
+void PhysicsStressInterface::PostPhysicsUpdate()
+{
+    uint64_t cycles = TickStats::sReadCycles() - m_StepStartCycles;
+    float stepMs = std::chrono::duration<float, std::milli>(Clock::now() - m_StepStart).count();
+
+    TickStats::sAdd(*m_StepEntry, 1, cycles);
+
+    m_Time += GetWorld()->GetTick().FixedTimeStep;
+
+    ++m_Steps;
+    m_StepMs += stepMs;
+    m_StepMaxMs = Math::Max(m_StepMaxMs, stepMs);
+
+    int stepsPerSample = Math::Max(int(1.0f / GetWorld()->GetTick().FixedTimeStep + 0.5f), 1);
+    if (m_Steps >= stepsPerSample)
+        FinishSample();
+}
+
+int PhysicsStressInterface::CountPairs()
+{
+    HK_TRACE_ZONE("PhysicsUpdate/StressPairs");
+
+    World* world = GetWorld();
+
+    m_Bounds.Clear();
+    for (TrackedObject const& tracked : m_Objects)
+    {
+        if (GameObject* object = world->GetObject(tracked.Handle))
+        {
+            Float3 position = object->GetWorldPosition();
+            m_Bounds.Add({position - Float3(tracked.Radius), position + Float3(tracked.Radius)});
+        }
+    }
+
+    std::sort(m_Bounds.begin(), m_Bounds.end(), [](Bounds const& a, Bounds const& b) { return a.Mins.X < b.Mins.X; });
+
+    int pairs = 0;
+    for (int i = 0; i < m_Bounds.Size(); ++i)
+    {
+        Bounds const& a = m_Bounds[i];
+        for (int j = i + 1; j < m_Bounds.Size() && m_Bounds[j].Mins.X <= a.Maxs.X; ++j)
+        {
+            Bounds const& b = m_Bounds[j];
+            if (a.Mins.Y <= b.Maxs.Y && b.Mins.Y <= a.Maxs.Y && a.Mins.Z <= b.Maxs.Z && b.Mins.Z <= a.Maxs.Z)
+                ++pairs;
+        }
+    }
+    return pairs;
+}
+
+void PhysicsStressInterface::FinishSample()
+{
+    Sample& sample = m_Samples.EmplaceBack();
+    sample.Time = m_Time;
+    sample.BodyCount = m_BodyCount;
+    sample.Steps = m_Steps;
+    sample.StepAvgMs = m_StepMs / m_Steps;
+    sample.StepMaxMs = m_StepMaxMs;
+    sample.Contacts = float(m_Contacts) / m_Steps;
+    sample.ContactsBegun = m_ContactsBegun;
+    sample.Pairs = CountPairs();
+    sample.TriggerOverlaps = m_TriggerOverlaps;
+
+    LOG("Physics stress {} s: bodies {} step avg {} ms max {} ms, contacts {}/step ({} new), pairs ~{}, trigger overlaps {}\n",
+        int(sample.Time + 0.5f), sample.BodyCount, sample.StepAvgMs, sample.StepMaxMs, int(sample.Contacts), sample.ContactsBegun, sample.Pairs, sample.TriggerOverlaps);
+
+    m_Steps = 0;
+    m_StepMs = 0;
+    m_StepMaxMs = 0;
+    m_Contacts = 0;
+    m_ContactsBegun = 0;
+}
+
+bool PhysicsStressInterface::WriteCsv(StringView filename) const
+{
+    String name(filename);
+    FILE* file = fopen(name.CStr(), "w");
+    if (!file)
+    {
+        LOG("Failed to write {}\n", name);
+        return false;
+    }
+
+    fprintf(file, "time_s,bodies,steps,step_avg_ms,step_max_ms,contacts_per_step,contacts_begun,pairs,trigger_overlaps\n");
+    for (Sample const& sample : m_Samples)
+    {
+        fprintf(file, "%.2f,%d,%d,%.4f,%.4f,%.1f,%d,%d,%d\n",
+                sample.Time, sample.BodyCount, sample.Steps, sample.StepAvgMs, sample.StepMaxMs, sample.Contacts, sample.ContactsBegun, sample.Pairs, sample.TriggerOverlaps);
+    }
+
+    fclose(file);
+
+    LOG("Physics stress samples written to {}\n", name);
+    return true;
+}
+
+HK_NAMESPACE_END
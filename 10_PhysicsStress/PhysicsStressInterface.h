@@ -0,0 +1,192 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/World/World.h>
+#include <Hork/World/Modules/Physics/PhysicsInterface.h>
+
+#include "Common/TickStats.h"
+
+#include <chrono>
+
+HK_NAMESPACE_BEGIN
+
+// Moves the kinematic movers of the stress scene and measures the physics under load.
+//
+// The step time is taken from the end of the FixedUpdate tick function of this interface to the
+// PhysicsUpdate tick function that runs after PhysicsInterface, so it includes the dispatch of contact
+// and overlap events. The FixedUpdate function lists the FixedUpdate interfaces of Source/Common as
+// prerequisites, so their work is not counted as part of the step; a new FixedUpdate interface used in
+// this sample has to be added there. It is also added to TickStats as the PhysicsStep group, so it shows up in
+// com_TickStats and in the phases of headless -perf results.
+//
+// The engine doesn't expose its broadphase, so the pair count is an estimate: the number of
+// overlapping bounding boxes of the spawned bodies, movers and triggers, found with sweep and prune
+// once per sample. Pairs with the map geometry are not counted.
+//
+// One sample is taken per simulated second, written to the log and kept for WriteCsv().
+class PhysicsStressInterface : public WorldInterface
+{
+public:
+    struct Sample
+    {
+        // Simulated seconds since the first step
+        float           Time;
+        int             BodyCount;
+        int             Steps;
+        float           StepAvgMs;
+        float           StepMaxMs;
+        // Begin and update contact callbacks per step, on average
+        float           Contacts;
+        // New contacts during the sample
+        int             ContactsBegun;
+        int             Pairs;
+        int             TriggerOverlaps;
+    };
+
+                        PhysicsStressInterface();
+
+    // Dynamic body with contact counting. Radius bounds the collider for the pair estimate.
+    void                AddBody(GameObject* object, float radius);
+
+    // Kinematic body moving along a horizontal circle, starting at the angle
+    void                AddMover(GameObject* object, Float3 const& center, float circleRadius, float angle, float speed, float radius);
+
+    void                AddTrigger(GameObject* object, float radius);
+
+    int                 GetBodyCount() const { return m_BodyCount; }
+
+    Vector<Sample> const& GetSamples() const { return m_Samples; }
+
+    // Writes the samples as comma separated values
+    bool                WriteCsv(StringView filename) const;
+
+    // Called by the components of the stress scene
+    void                OnContact(bool isNew)
+    {
+        ++m_Contacts;
+        if (isNew)
+            ++m_ContactsBegun;
+    }
+
+    void                OnTriggerOverlap(int delta) { m_TriggerOverlaps += delta; }
+
+protected:
+    void                Initialize() override;
+    void                Deinitialize() override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct TrackedObject
+    {
+        GameObjectHandle Handle;
+        float           Radius;
+    };
+
+    struct Mover
+    {
+        GameObjectHandle Handle;
+        Float3          Center;
+        float           CircleRadius;
+        float           Angle;
+        float           AngularSpeed;
+    };
+
+    struct Bounds
+    {
+        Float3          Mins;
+        Float3          Maxs;
+    };
+
+    void                FixedUpdate();
+    void                PostPhysicsUpdate();
+    int                 CountPairs();
+    void                FinishSample();
+
+    // Everything spawned, for the pair estimate
+    Vector<TrackedObject> m_Objects;
+    Vector<Mover>       m_Movers;
+    int                 m_BodyCount = 0;
+    Vector<Bounds>      m_Bounds;
+    Vector<Sample>      m_Samples;
+
+    // Simulated seconds
+    float               m_Time = 0;
+
+    Clock::time_point   m_StepStart;
+    uint64_t            m_StepStartCycles = 0;
+    TickStats::Entry*   m_StepEntry = nullptr;
+
+    // Current sample
+    int                 m_Steps = 0;
+    float               m_StepMs = 0;
+    float               m_StepMaxMs = 0;
+    int                 m_Contacts = 0;
+    int                 m_ContactsBegun = 0;
+    int                 m_TriggerOverlaps = 0;
+};
+
+// Dynamic body of the stress scene. Counts its contacts when the body dispatches contact events.
+class StressBodyComponent : public Component
+{
+public:
+    static constexpr ComponentMode Mode = ComponentMode::Static;
+
+    void OnBeginContact(Collision& collision)
+    {
+        GetWorld()->GetInterface<PhysicsStressInterface>().OnContact(true);
+    }
+
+    void OnUpdateContact(Collision& collision)
+    {
+        GetWorld()->GetInterface<PhysicsStressInterface>().OnContact(false);
+    }
+};
+
+// Trigger volume of the stress scene. Counts the bodies inside.
+class StressTriggerComponent : public Component
+{
+public:
+    static constexpr ComponentMode Mode = ComponentMode::Static;
+
+    void OnBeginOverlap(BodyComponent* body)
+    {
+        GetWorld()->GetInterface<PhysicsStressInterface>().OnTriggerOverlap(1);
+    }
+
+    void OnEndOverlap(BodyComponent* body)
+    {
+        GetWorld()->GetInterface<PhysicsStressInterface>().OnTriggerOverlap(-1);
+    }
+};
+
+HK_NAMESPACE_END
@@ -0,0 +1,349 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include <Hork/GameApplication/GameApplication.h>
+#include <Hork/Core/Logger.h>
+
+#include "Common/Lexer/Lexer.h"
+#include "Common/MapParser/MapGenerator.h"
+#include "Common/MapParser/Utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using namespace Hk;
+
+// Map generator and scaling benchmark of the map loading stages:
+//
+//     MapBenchmark -generate FILE [-brushes N] [-entities N] [-materials N] [-seed N]
+//     MapBenchmark -map MAP [-threads 1,2,4] [-repeat N] [-cluster SIZE] [-merge] [-perf FILE]
+//
+// The first form writes a synthetic map and exits. The second times Lexer, MapParser::Parse and
+// MapGeometry::Build with each thread count, every thread processing its own copy of the map at the same
+// time, so the throughput shows how the stages scale when maps load in parallel. The best of the repeats
+// is taken. Building the scene touches the world and resources, so it runs once on the main thread.
+// Throughput is in MB of map source and in brushes per second.
+//
+// Clip hull merging is off in all stages. With -merge, Build is timed once more with merging on and
+// reported as a separate BuildMerge stage.
+class MapBenchmarkApplication final : public GameApplication
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Result
+    {
+        int Threads;
+        double Ms;
+    };
+
+    String m_GenerateFile;
+    MapGeneratorSettings m_Generator;
+
+    String m_MapFilename;
+    String m_PerfFile;
+    Vector<int> m_ThreadCounts;
+    int m_Repeat = 3;
+    MapGeometrySettings m_GeometrySettings;
+    bool m_MeasureMerge = false;
+
+    size_t m_Bytes = 0;
+    int m_BrushCount = 0;
+
+public:
+    MapBenchmarkApplication(ArgumentPack const& args) :
+        GameApplication(args, "Hork Engine: Map Benchmark")
+    {
+        int i = args.Find("-generate");
+        if (i != -1 && i + 1 < args.Size())
+            m_GenerateFile = args.At(i + 1);
+
+        m_Generator.BrushCount = GetArgument(args, "-brushes", m_Generator.BrushCount);
+        m_Generator.EntityCount = GetArgument(args, "-entities", m_Generator.EntityCount);
+        m_Generator.MaterialCount = GetArgument(args, "-materials", m_Generator.MaterialCount);
+        m_Generator.Seed = GetArgument(args, "-seed", m_Generator.Seed);
+
+        i = args.Find("-map");
+        if (i != -1 && i + 1 < args.Size())
+            m_MapFilename = args.At(i + 1);
+
+        i = args.Find("-perf");
+        if (i != -1 && i + 1 < args.Size())
+            m_PerfFile = args.At(i + 1);
+
+        i = args.Find("-threads");
+        if (i != -1 && i + 1 < args.Size())
+        {
+            for (const char* s = args.At(i + 1); *s;)
+            {
+                char* end;
+                int count = int(std::strtol(s, &end, 10));
+                if (end == s)
+                    break;
+                if (count > 0)
+                    m_ThreadCounts.Add(count);
+                s = *end == ',' ? end + 1 : end;
+            }
+        }
+        if (m_ThreadCounts.IsEmpty())
+        {
+            // Powers of two up to the core count
+            int cores = Math::Max(int(std::thread::hardware_concurrency()), 1);
+            for (int count = 1; count <= cores; count *= 2)
+                m_ThreadCounts.Add(count);
+        }
+
+        m_Repeat = Math::Max(GetArgument(args, "-repeat", m_Repeat), 1);
+
+        i = args.Find("-cluster");
+        if (i != -1 && i + 1 < args.Size())
+            m_GeometrySettings.ClusterSize = float(std::atof(args.At(i + 1)));
+
+        // Merging is measured on its own, the generated grids are its worst case
+        m_GeometrySettings.MergeClipHulls = false;
+        m_MeasureMerge = args.Find("-merge") != -1;
+    }
+
+    void Initialize()
+    {
+        if (!m_GenerateFile.IsEmpty())
+            GenerateMap(m_GenerateFile, m_Generator);
+        else if (!m_MapFilename.IsEmpty())
+            Run();
+        else
+            LOG("Usage: MapBenchmark -generate FILE [-brushes N] [-entities N] [-materials N] [-seed N]\n"
+                "       MapBenchmark -map MAP [-threads 1,2,4] [-repeat N] [-cluster SIZE] [-merge] [-perf FILE]\n");
+
+        PostTerminateEvent();
+    }
+
+    void Deinitialize()
+    {}
+
+private:
+    static int GetArgument(ArgumentPack const& args, const char* name, int defaultValue)
+    {
+        int i = args.Find(name);
+        if (i != -1 && i + 1 < args.Size())
+            return Math::Max(std::atoi(args.At(i + 1)), 0);
+        return defaultValue;
+    }
+
+    static int sRunLexer(const char* source)
+    {
+        Lexer lex;
+        lex.SetName("Map");
+        lex.SetSource(source);
+        lex.AddOperator("{");
+        lex.AddOperator("}");
+        lex.AddOperator("(");
+        lex.AddOperator(")");
+
+        int tokenCount = 0;
+        while (lex.NextToken() == Lexer::ErrorCode::No)
+            ++tokenCount;
+        return tokenCount;
+    }
+
+    // Runs the job on each thread count, every thread at once, and keeps the best time of the repeats
+    template <typename Job>
+    Vector<Result> Measure(Job const& job) const
+    {
+        Vector<Result> results;
+        Vector<std::thread> threads;
+        for (int threadCount : m_ThreadCounts)
+        {
+            double bestMs = 0;
+            for (int repeat = 0; repeat < m_Repeat; ++repeat)
+            {
+                auto start = Clock::now();
+
+                threads.Clear();
+                for (int i = 1; i < threadCount; ++i)
+                    threads.EmplaceBack(job);
+                job();
+                for (std::thread& thread : threads)
+                    thread.join();
+
+                double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                if (repeat == 0 || ms < bestMs)
+                    bestMs = ms;
+            }
+            results.Add({threadCount, bestMs});
+        }
+        return results;
+    }
+
+    double GetMBPerSecond(Result const& result) const
+    {
+        return result.Ms > 0 ? result.Threads * m_Bytes / (1024.0 * 1024.0) / (result.Ms / 1000) : 0;
+    }
+
+    double GetBrushesPerSecond(Result const& result) const
+    {
+        return result.Ms > 0 ? result.Threads * m_BrushCount / (result.Ms / 1000) : 0;
+    }
+
+    void PrintResults(const char* stage, Vector<Result> const& results) const
+    {
+        for (Result const& result : results)
+        {
+            LOG("  {:<10} {:>3} threads {:>10.2f} ms {:>10.2f} MB/s {:>12.0f} brushes/s\n",
+                stage, result.Threads, result.Ms, GetMBPerSecond(result), GetBrushesPerSecond(result));
+        }
+    }
+
+    void WriteResults(FILE* output, const char* stage, Vector<Result> const& results) const
+    {
+        fprintf(output, "  \"%s\": [", stage);
+        for (int i = 0; i < results.Size(); ++i)
+        {
+            Result const& result = results[i];
+            fprintf(output, "%s\n    {\"threads\": %d, \"ms\": %.3f, \"mb_per_s\": %.3f, \"brushes_per_s\": %.1f}",
+                    i ? "," : "", result.Threads, result.Ms, GetMBPerSecond(result), GetBrushesPerSecond(result));
+        }
+        fprintf(output, "\n  ]");
+    }
+
+    void Run()
+    {
+        auto& resourceMngr = sGetResourceManager();
+
+        // The default material of map surfaces
+        sGetMaterialManager().LoadLibrary("/Root/default/materials/default.mlib");
+
+        auto file = resourceMngr.OpenFile(m_MapFilename);
+        if (!file)
+        {
+            LOG("MapBenchmark: Failed to open {}\n", m_MapFilename);
+            return;
+        }
+        String source = file.AsString();
+        m_Bytes = source.Size();
+
+        // Geometry of all threads is built from this one, parsing is measured separately
+        MapParser parser;
+        parser.Parse(source.CStr());
+        m_BrushCount = parser.GetBrushes().Size();
+
+        int tokenCount = sRunLexer(source.CStr());
+
+        LOG("MapBenchmark: {}: {} KB, {} tokens, {} entities, {} brushes, {} faces\n",
+            m_MapFilename, m_Bytes / 1024, tokenCount, parser.GetEntities().Size(), m_BrushCount, parser.GetFaces().Size());
+
+        Vector<Result> lexer = Measure([&source]()
+        {
+            sRunLexer(source.CStr());
+        });
+        PrintResults("Lexer", lexer);
+
+        Vector<Result> parse = Measure([&source]()
+        {
+            MapParser threadParser;
+            threadParser.Parse(source.CStr());
+        });
+        PrintResults("Parse", parse);
+
+        Vector<Result> build = Measure([this, &parser]()
+        {
+            MapGeometry geometry;
+            geometry.Build(parser, m_GeometrySettings);
+        });
+        PrintResults("Build", build);
+
+        Vector<Result> buildMerge;
+        if (m_MeasureMerge)
+        {
+            MapGeometrySettings mergeSettings = m_GeometrySettings;
+            mergeSettings.MergeClipHulls = true;
+
+            buildMerge = Measure([&parser, &mergeSettings]()
+            {
+                MapGeometry geometry;
+                geometry.Build(parser, mergeSettings);
+            });
+            PrintResults("BuildMerge", buildMerge);
+        }
+
+        // Reads, parses and builds the map again, then creates the resources and objects
+        Vector<Result> scene;
+        {
+            World* world = CreateWorld();
+
+            auto start = Clock::now();
+            MapLoader loader;
+            if (loader.Load(m_MapFilename, m_GeometrySettings))
+                loader.CreateScene(world);
+            scene.Add({1, std::chrono::duration<double, std::milli>(Clock::now() - start).count()});
+
+            DestroyWorld(world);
+            loader.PurgeResources();
+        }
+        PrintResults("Scene", scene);
+
+        if (m_PerfFile.IsEmpty())
+            return;
+
+        FILE* output = fopen(m_PerfFile.CStr(), "w");
+        if (!output)
+        {
+            LOG("Failed to write {}\n", m_PerfFile);
+            return;
+        }
+
+        fprintf(output, "{\n");
+        fprintf(output, "  \"map\": \"%s\",\n", m_MapFilename.CStr());
+        fprintf(output, "  \"bytes\": %zu,\n", m_Bytes);
+        fprintf(output, "  \"tokens\": %d,\n", tokenCount);
+        fprintf(output, "  \"entities\": %d,\n", int(parser.GetEntities().Size()));
+        fprintf(output, "  \"brushes\": %d,\n", m_BrushCount);
+        fprintf(output, "  \"faces\": %d,\n", int(parser.GetFaces().Size()));
+        WriteResults(output, "lexer", lexer);
+        fprintf(output, ",\n");
+        WriteResults(output, "parse", parse);
+        fprintf(output, ",\n");
+        WriteResults(output, "build", build);
+        fprintf(output, ",\n");
+        if (m_MeasureMerge)
+        {
+            WriteResults(output, "build_merge", buildMerge);
+            fprintf(output, ",\n");
+        }
+        WriteResults(output, "scene", scene);
+        fprintf(output, "\n}\n");
+        fclose(output);
+
+        LOG("Benchmark results written to {}\n", m_PerfFile);
+    }
+};
+
+using ApplicationClass = MapBenchmarkApplication;
+#include "Common/EntryPoint.h"
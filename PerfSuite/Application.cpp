@@ -0,0 +1,180 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include <Hork/GameApplication/GameApplication.h>
+#include <Hork/Core/Logger.h>
+
+#include "Common/MapParser/Utils.h"
+#include "Common/MemoryTags.h"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace Hk;
+
+// Load-only benchmark of one map for the performance suite:
+//
+//     PerfSuite -map /Root/sample2.map -perf map_sample2.json
+//
+// Times parsing, geometry building, the whole resident load and scene construction, writes the
+// results with the memory peaks to the JSON file and exits.
+class PerfApplication final : public GameApplication
+{
+    using Clock = std::chrono::steady_clock;
+
+    String m_MapFilename;
+    String m_PerfFile;
+
+public:
+    PerfApplication(ArgumentPack const& args) :
+        GameApplication(args, "Hork Engine: Perf Suite")
+    {
+        int i = args.Find("-map");
+        if (i != -1 && i + 1 < args.Size())
+            m_MapFilename = args.At(i + 1);
+
+        i = args.Find("-perf");
+        if (i != -1 && i + 1 < args.Size())
+            m_PerfFile = args.At(i + 1);
+    }
+
+    void Initialize()
+    {
+        if (m_MapFilename.IsEmpty() || m_PerfFile.IsEmpty())
+            LOG("Usage: PerfSuite -map MAP -perf FILE\n");
+        else
+            Run();
+
+        PostTerminateEvent();
+    }
+
+    void Deinitialize()
+    {}
+
+private:
+    static double sElapsedMs(Clock::time_point& time)
+    {
+        auto now = Clock::now();
+        double ms = std::chrono::duration<double, std::milli>(now - time).count();
+        time = now;
+        return ms;
+    }
+
+    void Run()
+    {
+        auto& resourceMngr = sGetResourceManager();
+
+        // The default material of map surfaces
+        sGetMaterialManager().LoadLibrary("/Root/default/materials/default.mlib");
+
+        MemoryReport report;
+
+        auto time = Clock::now();
+
+        // Parse and build on their own first, to split the load time
+        auto file = resourceMngr.OpenFile(m_MapFilename);
+        if (!file)
+        {
+            LOG("PerfSuite: Failed to open {}\n", m_MapFilename);
+            return;
+        }
+        String source = file.AsString();
+        double readMs = sElapsedMs(time);
+
+        int surfaceCount, clipHullCount;
+        double parseMs, buildMs;
+        {
+            MapParser parser;
+            parser.SetMemoryReport(&report);
+            parser.Parse(source.CStr());
+            parseMs = sElapsedMs(time);
+
+            MapGeometry geometry;
+            geometry.SetMemoryReport(&report);
+            geometry.Build(parser);
+            buildMs = sElapsedMs(time);
+
+            surfaceCount = geometry.GetSurfaces().Size();
+            clipHullCount = geometry.GetClipHulls().Size();
+        }
+        // Freeing the parser and the geometry is not part of any phase
+        sElapsedMs(time);
+
+        MapLoader loader;
+        loader.SetMemoryReport(&report);
+        if (!loader.Load(m_MapFilename))
+        {
+            LOG("PerfSuite: Failed to load {}\n", m_MapFilename);
+            return;
+        }
+        double loadMs = sElapsedMs(time);
+
+        World* world = CreateWorld();
+        loader.CreateScene(world);
+        double sceneMs = sElapsedMs(time);
+
+        DestroyWorld(world);
+        loader.PurgeResources();
+
+        report.Print(m_MapFilename);
+
+        FILE* output = fopen(m_PerfFile.CStr(), "w");
+        if (!output)
+        {
+            LOG("Failed to write {}\n", m_PerfFile);
+            return;
+        }
+
+        fprintf(output, "{\n");
+        fprintf(output, "  \"map\": \"%s\",\n", m_MapFilename.CStr());
+        fprintf(output, "  \"surfaces\": %d,\n", surfaceCount);
+        fprintf(output, "  \"clip_hulls\": %d,\n", clipHullCount);
+        fprintf(output, "  \"read_ms\": %.3f,\n", readMs);
+        fprintf(output, "  \"parse_ms\": %.3f,\n", parseMs);
+        fprintf(output, "  \"build_ms\": %.3f,\n", buildMs);
+        fprintf(output, "  \"load_ms\": %.3f,\n", loadMs);
+        fprintf(output, "  \"scene_ms\": %.3f,\n", sceneMs);
+        fprintf(output, "  \"memory\": {\n");
+        fprintf(output, "    \"peak_rss_mb\": %.3f,\n", MemoryTracker::sGetProcessPeakMemory() / (1024.0 * 1024.0));
+        fprintf(output, "    \"tracked_peak_mb\": %.3f", MemoryTracker::sGet().GetPeak() / (1024.0 * 1024.0));
+        for (int tag = 0; tag < int(MemoryTag::Count); ++tag)
+        {
+            auto stats = MemoryTracker::sGet().GetStats(MemoryTag(tag));
+            fprintf(output, ",\n    \"%s\": {\n      \"peak_mb\": %.3f\n    }", MemoryTracker::sGetTagName(MemoryTag(tag)), stats.Peak / (1024.0 * 1024.0));
+        }
+        fprintf(output, "\n  }\n}\n");
+        fclose(output);
+
+        LOG("Performance results written to {}\n", m_PerfFile);
+    }
+};
+
+using ApplicationClass = PerfApplication;
+#include "Common/EntryPoint.h"
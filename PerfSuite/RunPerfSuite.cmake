@@ -0,0 +1,224 @@
+# Runs the performance suite. Called by the perf_suite and perf_suite_baseline targets with:
+#
+#   RUNS              sample=executable pairs separated by |
+#   MAP_TOOL          map loading benchmark
+#   DATA_DIR          directory with the maps
+#   TICKS             world ticks of each sample run
+#   OUTPUT_DIR        directory for the results, the logs and a new baseline
+#   BASELINE          committed baseline results
+#   REPEAT            runs of each benchmark, the median of every metric is compared
+#   TIME_THRESHOLD    allowed time regression in percent
+#   TAIL_THRESHOLD    allowed regression of p95 and p99 tick times in percent
+#   MEMORY_THRESHOLD  allowed memory regression in percent
+#   UPDATE_BASELINE   write the results to OUTPUT_DIR/baseline.json instead of comparing
+#
+# Only the metrics listed in METRICS are compared. Differences below MIN_DELTA_MS and MIN_DELTA_MB are noise.
+# A baseline without metrics, or one that shares none with the results, fails the suite like a missing one.
+# Nothing is written outside OUTPUT_DIR; copy a new baseline over the committed one to update it.
+
+cmake_minimum_required(VERSION 3.19)
+
+set(METRICS load_ms read_ms parse_ms build_ms scene_ms p50_ms p95_ms p99_ms peak_rss_mb tracked_peak_mb peak_mb)
+set(MIN_DELTA_MS 0.1)
+set(MIN_DELTA_MB 1)
+
+file(MAKE_DIRECTORY ${OUTPUT_DIR})
+
+if(NOT UPDATE_BASELINE AND NOT EXISTS ${BASELINE})
+    message(FATAL_ERROR "perf_suite: baseline ${BASELINE} is missing, build perf_suite_baseline and copy its result there")
+endif()
+
+set(RESULTS "{}")
+set(FAILED_RUNS)
+
+# Collects the numbers of the compared metrics as path=value
+function(collect_metrics JSON PREFIX OUT)
+    set(METRIC_VALUES)
+    string(JSON COUNT LENGTH "${JSON}")
+    if(COUNT GREATER 0)
+        math(EXPR LAST "${COUNT} - 1")
+        foreach(INDEX RANGE ${LAST})
+            string(JSON KEY MEMBER "${JSON}" ${INDEX})
+            string(JSON TYPE TYPE "${JSON}" "${KEY}")
+            if(TYPE STREQUAL "OBJECT")
+                string(JSON CHILD GET "${JSON}" "${KEY}")
+                collect_metrics("${CHILD}" "${PREFIX}${KEY}/" CHILD_VALUES)
+                list(APPEND METRIC_VALUES ${CHILD_VALUES})
+            elseif(TYPE STREQUAL "NUMBER" AND KEY IN_LIST METRICS)
+                string(JSON VALUE GET "${JSON}" "${KEY}")
+                list(APPEND METRIC_VALUES "${PREFIX}${KEY}=${VALUE}")
+            endif()
+        endforeach()
+    endif()
+    set(${OUT} ${METRIC_VALUES} PARENT_SCOPE)
+endfunction()
+
+# CMake math is integer only, so values are compared in thousandths. Tiny values may come back from
+# string(JSON) with a negative exponent and count as zero.
+function(to_milli VALUE OUT)
+    if(VALUE MATCHES "[eE]-")
+        set(MILLI 0)
+    elseif(VALUE MATCHES "^([0-9]+)\\.?([0-9]*)")
+        set(WHOLE ${CMAKE_MATCH_1})
+        string(SUBSTRING "${CMAKE_MATCH_2}000" 0 3 FRACTION)
+        math(EXPR MILLI "${WHOLE} * 1000 + 1${FRACTION} - 1000")
+    else()
+        set(MILLI 0)
+    endif()
+    set(${OUT} ${MILLI} PARENT_SCOPE)
+endfunction()
+
+# Runs the benchmark REPEAT times and adds its results as member NAME of RESULTS. Compared metrics hold
+# the median of the runs, the other members come from the first run.
+function(run_benchmark NAME)
+    foreach(RUN_INDEX RANGE 1 ${REPEAT})
+        set(OUTPUT "${OUTPUT_DIR}/${NAME}_${RUN_INDEX}.json")
+        set(LOG "${OUTPUT_DIR}/${NAME}_${RUN_INDEX}.log")
+        file(REMOVE ${OUTPUT})
+
+        message(STATUS "perf_suite: ${NAME} (${RUN_INDEX}/${REPEAT})")
+        execute_process(COMMAND ${ARGN} -perf ${OUTPUT}
+            RESULT_VARIABLE RESULT
+            OUTPUT_FILE ${LOG}
+            ERROR_FILE ${LOG})
+
+        if(NOT RESULT EQUAL 0 OR NOT EXISTS ${OUTPUT})
+            message(SEND_ERROR "perf_suite: ${NAME} failed (${RESULT}), see ${LOG}")
+            set(FAILED_RUNS ${FAILED_RUNS} ${NAME} PARENT_SCOPE)
+            return()
+        endif()
+
+        file(READ ${OUTPUT} RUN_JSON)
+        if(RUN_INDEX EQUAL 1)
+            set(JSON "${RUN_JSON}")
+        endif()
+
+        collect_metrics("${RUN_JSON}" "" RUN_VALUES)
+        foreach(ENTRY ${RUN_VALUES})
+            string(REGEX MATCH "^(.*)=(.*)$" MATCHED "${ENTRY}")
+            set(METRIC_PATH ${CMAKE_MATCH_1})
+            set(VALUE ${CMAKE_MATCH_2})
+            to_milli(${VALUE} VALUE_MILLI)
+            list(APPEND "SAMPLES_${METRIC_PATH}" "${VALUE_MILLI}=${VALUE}")
+        endforeach()
+    endforeach()
+
+    collect_metrics("${JSON}" "" FIRST_VALUES)
+    foreach(ENTRY ${FIRST_VALUES})
+        string(REGEX MATCH "^(.*)=" MATCHED "${ENTRY}")
+        set(METRIC_PATH ${CMAKE_MATCH_1})
+
+        # Sorted by the value in thousandths, the middle sample is the median
+        set(SAMPLES ${SAMPLES_${METRIC_PATH}})
+        list(SORT SAMPLES COMPARE NATURAL)
+        list(LENGTH SAMPLES COUNT)
+        math(EXPR MIDDLE "${COUNT} / 2")
+        list(GET SAMPLES ${MIDDLE} MEDIAN)
+        string(REGEX REPLACE "^[^=]*=" "" MEDIAN "${MEDIAN}")
+
+        string(REPLACE "/" ";" KEYS "${METRIC_PATH}")
+        string(JSON JSON SET "${JSON}" ${KEYS} ${MEDIAN})
+    endforeach()
+
+    string(JSON RESULTS SET "${RESULTS}" "${NAME}" "${JSON}")
+    set(RESULTS "${RESULTS}" PARENT_SCOPE)
+endfunction()
+
+# An empty baseline would skip every metric, so it fails before anything runs
+if(NOT UPDATE_BASELINE)
+    file(READ ${BASELINE} BASELINE_JSON)
+    collect_metrics("${BASELINE_JSON}" "" BASELINE_VALUES)
+    if(NOT BASELINE_VALUES)
+        message(FATAL_ERROR "perf_suite: baseline ${BASELINE} has no metrics, build perf_suite_baseline and copy its result there")
+    endif()
+endif()
+
+string(REPLACE "|" ";" RUNS "${RUNS}")
+foreach(RUN ${RUNS})
+    string(REGEX MATCH "^([^=]+)=(.*)$" MATCHED "${RUN}")
+    run_benchmark(${CMAKE_MATCH_1} ${CMAKE_MATCH_2} -headless -unlocked -script -ticks ${TICKS})
+endforeach()
+
+file(GLOB MAPS ${DATA_DIR}/*.map)
+foreach(MAP ${MAPS})
+    get_filename_component(MAP_NAME ${MAP} NAME)
+    get_filename_component(MAP_STEM ${MAP} NAME_WE)
+    run_benchmark(map_${MAP_STEM} ${MAP_TOOL} -map /Root/${MAP_NAME})
+endforeach()
+
+file(WRITE ${OUTPUT_DIR}/perf_results.json "${RESULTS}\n")
+message(STATUS "perf_suite: results written to ${OUTPUT_DIR}/perf_results.json")
+
+if(FAILED_RUNS)
+    message(FATAL_ERROR "perf_suite: failed runs: ${FAILED_RUNS}")
+endif()
+
+if(UPDATE_BASELINE)
+    file(WRITE ${OUTPUT_DIR}/baseline.json "${RESULTS}\n")
+    message(STATUS "perf_suite: baseline written to ${OUTPUT_DIR}/baseline.json, copy it to ${BASELINE} to use it")
+    return()
+endif()
+
+foreach(ENTRY ${BASELINE_VALUES})
+    string(REGEX MATCH "^(.*)=(.*)$" MATCHED "${ENTRY}")
+    set("BASE_${CMAKE_MATCH_1}" ${CMAKE_MATCH_2})
+endforeach()
+
+collect_metrics("${RESULTS}" "" CURRENT_VALUES)
+
+set(REGRESSIONS 0)
+set(COMPARED 0)
+foreach(ENTRY ${CURRENT_VALUES})
+    string(REGEX MATCH "^(.*)=(.*)$" MATCHED "${ENTRY}")
+    set(METRIC_PATH ${CMAKE_MATCH_1})
+    set(VALUE ${CMAKE_MATCH_2})
+
+    # New runs and metrics have nothing to compare with until the baseline is updated
+    if(NOT DEFINED "BASE_${METRIC_PATH}")
+        message(STATUS "perf_suite: no baseline for ${METRIC_PATH}")
+        continue()
+    endif()
+
+    math(EXPR COMPARED "${COMPARED} + 1")
+
+    if(METRIC_PATH MATCHES "_mb$")
+        set(THRESHOLD ${MEMORY_THRESHOLD})
+        set(MIN_DELTA ${MIN_DELTA_MB})
+    elseif(METRIC_PATH MATCHES "p9[59]_ms$")
+        set(THRESHOLD ${TAIL_THRESHOLD})
+        set(MIN_DELTA ${MIN_DELTA_MS})
+    else()
+        set(THRESHOLD ${TIME_THRESHOLD})
+        set(MIN_DELTA ${MIN_DELTA_MS})
+    endif()
+
+    to_milli(${BASE_${METRIC_PATH}} BASE_MILLI)
+    to_milli(${VALUE} VALUE_MILLI)
+    to_milli(${MIN_DELTA} MIN_DELTA_MILLI)
+
+    math(EXPR LIMIT "${BASE_MILLI} + ${BASE_MILLI} * ${THRESHOLD} / 100")
+    math(EXPR MIN_LIMIT "${BASE_MILLI} + ${MIN_DELTA_MILLI}")
+    if(LIMIT LESS MIN_LIMIT)
+        set(LIMIT ${MIN_LIMIT})
+    endif()
+
+    if(VALUE_MILLI GREATER LIMIT)
+        if(BASE_MILLI GREATER 0)
+            math(EXPR PERCENT "(${VALUE_MILLI} - ${BASE_MILLI}) * 100 / ${BASE_MILLI}")
+        else()
+            set(PERCENT "inf")
+        endif()
+        message(STATUS "perf_suite: REGRESSION ${METRIC_PATH}: ${BASE_${METRIC_PATH}} -> ${VALUE} (+${PERCENT}%)")
+        math(EXPR REGRESSIONS "${REGRESSIONS} + 1")
+    endif()
+endforeach()
+
+if(COMPARED EQUAL 0)
+    message(FATAL_ERROR "perf_suite: no metric matches ${BASELINE}, build perf_suite_baseline and copy its result there")
+endif()
+
+if(REGRESSIONS GREATER 0)
+    message(FATAL_ERROR "perf_suite: ${REGRESSIONS} metrics regressed against ${BASELINE}")
+endif()
+
+message(STATUS "perf_suite: ${COMPARED} metrics compared, no regressions against ${BASELINE}")
@@ -0,0 +1,101 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "CommandBuffer.h"
+#include "Interfaces/DestructionInterface.h"
+
+#include <Hork/World/Modules/Physics/Components/CharacterControllerComponent.h>
+#include <Hork/World/Modules/Physics/Components/DynamicBodyComponent.h>
+
+HK_NAMESPACE_BEGIN
+
+void CommandBuffer::DestroyObject(GameObjectHandle object)
+{
+    Command& command = m_Commands.EmplaceBack();
+    command.Type = CommandType::DestroyObject;
+    command.Object = object;
+}
+
+void CommandBuffer::SetPosition(GameObjectHandle object, Float3 const& position)
+{
+    Command& command = m_Commands.EmplaceBack();
+    command.Type = CommandType::SetPosition;
+    command.Object = object;
+    command.Vector = position;
+}
+
+void CommandBuffer::SetRotation(GameObjectHandle object, Quat const& rotation)
+{
+    Command& command = m_Commands.EmplaceBack();
+    command.Type = CommandType::SetRotation;
+    command.Object = object;
+    command.Rotation = rotation;
+}
+
+void CommandBuffer::SetLinearVelocity(GameObjectHandle object, Float3 const& velocity)
+{
+    Command& command = m_Commands.EmplaceBack();
+    command.Type = CommandType::SetLinearVelocity;
+    command.Object = object;
+    command.Vector = velocity;
+}
+
+void CommandBuffer::Execute(World* world)
+{
+    for (Command const& command : m_Commands)
+    {
+        GameObject* object = world->GetObject(command.Object);
+        if (!object)
+            continue;
+
+        switch (command.Type)
+        {
+        case CommandType::DestroyObject:
+            world->GetInterface<DestructionInterface>().Destroy(command.Object);
+            break;
+        case CommandType::SetPosition:
+            object->SetPosition(command.Vector);
+            break;
+        case CommandType::SetRotation:
+            object->SetRotation(command.Rotation);
+            break;
+        case CommandType::SetLinearVelocity:
+            if (auto controller = object->GetComponent<CharacterControllerComponent>())
+                controller->SetLinearVelocity(command.Vector);
+            else if (auto body = object->GetComponent<DynamicBodyComponent>())
+                body->SetLinearVelocity(command.Vector);
+            break;
+        }
+    }
+
+    m_Commands.Clear();
+}
+
+HK_NAMESPACE_END
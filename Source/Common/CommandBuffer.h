@@ -0,0 +1,81 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/World/World.h>
+
+HK_NAMESPACE_BEGIN
+
+// Records world mutations made from worker threads. Commands are executed later on the main
+// thread in the order they were recorded.
+class CommandBuffer final
+{
+public:
+    // Queued to DestructionInterface
+    void                DestroyObject(GameObjectHandle object);
+
+    void                SetPosition(GameObjectHandle object, Float3 const& position);
+
+    void                SetRotation(GameObjectHandle object, Quat const& rotation);
+
+    // Applied to the object's character controller or dynamic body
+    void                SetLinearVelocity(GameObjectHandle object, Float3 const& velocity);
+
+    // Applies the commands and clears the buffer. Objects destroyed in the meantime are skipped.
+    void                Execute(World* world);
+
+    void                Clear() { m_Commands.Clear(); }
+
+    bool                IsEmpty() const { return m_Commands.IsEmpty(); }
+
+    int                 GetCommandCount() const { return m_Commands.Size(); }
+
+private:
+    enum class CommandType : uint8_t
+    {
+        DestroyObject,
+        SetPosition,
+        SetRotation,
+        SetLinearVelocity
+    };
+
+    struct Command
+    {
+        CommandType     Type;
+        GameObjectHandle Object;
+        Float3          Vector;
+        Quat            Rotation;
+    };
+
+    Vector<Command>     m_Commands;
+};
+
+HK_NAMESPACE_END
@@ -46,12 +46,7 @@ public:
         for (auto part : Parts)
         {
             if (auto door = GetWorld()->GetComponent(part))
-            {
-                if (door->m_DoorState == DoorComponent::STATE_CLOSED)
-                    door->m_DoorState = DoorComponent::STATE_OPENING;
-
-                door->m_bIsActive = true;
-            }
+                door->SetActive(true);
         }
     }
 
@@ -60,9 +55,7 @@ public:
         for (auto part : Parts)
         {
             if (auto door = GetWorld()->GetComponent(part))
-            {
-                door->m_bIsActive = false;
-            }
+                door->SetActive(false);
         }
     }
 };
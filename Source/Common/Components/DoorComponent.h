@@ -32,8 +32,11 @@ SOFTWARE.
 
 #include <Hork/World/World.h>
 
+#include "../Interfaces/MoverInterface.h"
+
 using namespace Hk;
 
+// Door part. Movement is done by MoverInterface.
 class DoorComponent : public Component
 {
 public:
@@ -45,69 +48,30 @@ public:
     float m_OpenSpeed{1};
     float m_CloseSpeed{1};
 
-    enum DOOR_STATE
+    // Keeps the door open while set
+    void SetActive(bool isActive)
     {
-        STATE_CLOSED,
-        STATE_OPENED,
-        STATE_OPENING,
-        STATE_CLOSING
-    };
-    DOOR_STATE m_DoorState{STATE_CLOSED};
-    float m_NextThinkTime{};
-    float m_OpenDist{};
-    bool m_bIsActive = false;
-    Hk::Float3 m_StartPosition;
+        GetWorld()->GetInterface<MoverInterface>().SetHold(m_Mover, isActive);
+    }
 
     void BeginPlay()
     {
-        m_StartPosition = GetOwner()->GetPosition();
+        MoverDesc desc;
+        desc.Direction = Direction;
+        desc.Distance = m_MaxOpenDist;
+        desc.OpenSpeed = m_OpenSpeed;
+        desc.CloseSpeed = m_CloseSpeed;
+        desc.WaitTime = 2;
+
+        m_Mover = GetWorld()->GetInterface<MoverInterface>().AddMover(GetOwner(), desc);
     }
 
-    void FixedUpdate()
+    void EndPlay()
     {
-        float timeStep = GetWorld()->GetTick().FixedTimeStep;
-
-        if (m_bIsActive)
-        {
-            if (m_DoorState == DoorComponent::STATE_CLOSED)
-                m_DoorState = DoorComponent::STATE_OPENING;
-            else if (m_DoorState == DoorComponent::STATE_OPENED)
-                m_NextThinkTime = 2;
-        }
-
-        switch (m_DoorState)
-        {
-            case DoorComponent::STATE_CLOSED:
-                break;
-            case DoorComponent::STATE_OPENED: {
-                m_NextThinkTime -= timeStep;
-                if (m_NextThinkTime <= 0)
-                {
-                    m_DoorState = DoorComponent::STATE_CLOSING;
-                }
-                break;
-            }
-            case DoorComponent::STATE_OPENING: {
-                m_OpenDist += timeStep * m_OpenSpeed;
-                if (m_OpenDist >= m_MaxOpenDist)
-                {
-                    m_OpenDist = m_MaxOpenDist;
-                    m_DoorState = DoorComponent::STATE_OPENED;
-                    m_NextThinkTime = 2;
-                }
-                GetOwner()->SetPosition(m_StartPosition + Direction * m_OpenDist);
-                break;
-            }
-            case DoorComponent::STATE_CLOSING: {
-                m_OpenDist -= timeStep * m_CloseSpeed;
-                if (m_OpenDist <= 0)
-                {
-                    m_OpenDist = 0;
-                    m_DoorState = DoorComponent::STATE_CLOSED;
-                }
-                GetOwner()->SetPosition(m_StartPosition + Direction * m_OpenDist);
-                break;
-            }
-        }
+        GetWorld()->GetInterface<MoverInterface>().RemoveMover(m_Mover);
+        m_Mover = 0;
     }
+
+private:
+    MoverID m_Mover{};
 };
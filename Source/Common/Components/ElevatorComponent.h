@@ -32,88 +32,47 @@ SOFTWARE.
 
 #include <Hork/World/World.h>
 
+#include "../Interfaces/MoverInterface.h"
+
 using namespace Hk;
 
+// Elevator platform. Movement is done by MoverInterface.
 class ElevatorComponent : public Component
 {
-    enum State
-    {
-        Idle, MoveUp, Stay, MoveDown
-    };
-    State m_State = Idle;
-    float m_StartY = 0;
-    float m_Height = 0;
-    float m_StayTime = 0;
-
-    void UpdatePosition()
-    {
-        Float3 position = GetOwner()->GetWorldPosition();
-        position.Y = m_StartY + m_Height;
-
-        GetOwner()->SetWorldPosition(position);
-    }
-
 public:
     static constexpr ComponentMode Mode = ComponentMode::Static;
 
-    bool IsTriggered = false;
-
     float MaxHeight = 0;
 
-    void BeginPlay()
+    // Lifts the elevator once it is down
+    void Trigger()
     {
-        m_StartY = GetOwner()->GetWorldPosition().Y;
-        m_Height = 0;
+        GetWorld()->GetInterface<MoverInterface>().Trigger(m_Mover);
     }
 
-    void FixedUpdate()
+    void BeginPlay()
     {
         const float MAX_STAY_TIME = 3;
         const float MOVE_SPEED = 3;
 
-        float timeStep = GetWorld()->GetTick().FixedTimeStep;
+        MoverDesc desc;
+        desc.Direction = Float3(0, 1, 0);
+        desc.Distance = MaxHeight;
+        desc.OpenSpeed = MOVE_SPEED;
+        desc.CloseSpeed = MOVE_SPEED;
+        desc.WaitTime = MAX_STAY_TIME;
 
-        if (IsTriggered)
-        {
-            if (m_State == Idle)
-            {
-                m_State = MoveUp;
-                IsTriggered = false;
-            }
-        }
+        m_Mover = GetWorld()->GetInterface<MoverInterface>().AddMover(GetOwner(), desc);
+    }
 
-        switch (m_State)
-        {
-        case MoveUp:
-            m_Height += MOVE_SPEED * timeStep;
-            if (m_Height > MaxHeight)
-            {
-                m_Height = MaxHeight;
-                m_State = Stay;
-            }
-            UpdatePosition();
-            break;
-        case MoveDown:
-            m_Height -= MOVE_SPEED * timeStep;
-            if (m_Height < 0)
-            {
-                m_Height = 0;
-                m_State = Idle;
-            }
-            UpdatePosition();
-            break;
-        case Stay:
-            m_StayTime += timeStep;
-            if (m_StayTime > MAX_STAY_TIME)
-            {
-                m_StayTime = 0;
-                m_State = MoveDown;
-            }
-            break;
-        case Idle:
-            break;
-        }
+    void EndPlay()
+    {
+        GetWorld()->GetInterface<MoverInterface>().RemoveMover(m_Mover);
+        m_Mover = 0;
     }
+
+private:
+    MoverID m_Mover{};
 };
 
 class ElevatorActivatorComponent : public Component
@@ -127,7 +86,7 @@ public:
     {
         if (auto elevatorComp = GetWorld()->GetComponent(Elevator))
         {
-            elevatorComp->IsTriggered = true;
-        }        
+            elevatorComp->Trigger();
+        }
     }
 };
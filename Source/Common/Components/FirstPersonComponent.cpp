@@ -30,6 +30,7 @@ SOFTWARE.
 
 #include "FirstPersonComponent.h"
 #include "ProjectileComponent.h"
+#include "../Interfaces/HitscanInterface.h"
 #include "../CollisionLayer.h"
 
 #include <Hork/World/Modules/Physics/Components/CharacterControllerComponent.h>
@@ -44,6 +45,7 @@ void FirstPersonComponent::BindInput(InputBindings& input)
     input.BindAxis("MoveRight", this, &FirstPersonComponent::MoveRight);
 
     input.BindAction("Attack", this, &FirstPersonComponent::Attack, InputEvent::OnPress);
+    input.BindAction("SwitchWeapon", this, &FirstPersonComponent::SwitchWeapon, InputEvent::OnPress);
 
     input.BindAxis("TurnRight", this, &FirstPersonComponent::TurnRight);
     input.BindAxis("TurnUp", this, &FirstPersonComponent::TurnUp);
@@ -54,55 +56,129 @@ void FirstPersonComponent::BindInput(InputBindings& input)
     input.BindAxis("MoveUp", this, &FirstPersonComponent::MoveUp);
 }
 
+PlayerInputFrame FirstPersonComponent::TakeRecordedInput()
+{
+    PlayerInputFrame input = m_RecordedInput;
+
+    // Move axes keep their value until the next input event, rotations and actions are consumed
+    for (int axis = PlayerInputFrame::TurnRight; axis < PlayerInputFrame::AxisCount; ++axis)
+        m_RecordedInput.Axes[axis] = 0;
+    m_RecordedInput.Actions = 0;
+
+    return input;
+}
+
+void FirstPersonComponent::ReplayInput(PlayerInputFrame const& input)
+{
+    MoveForward(input.Axes[PlayerInputFrame::MoveForward]);
+    MoveRight(input.Axes[PlayerInputFrame::MoveRight]);
+    MoveUp(input.Axes[PlayerInputFrame::MoveUp]);
+
+    // Rotations are recorded as the angle of the tick, zero means the axis wasn't touched
+    if (input.Axes[PlayerInputFrame::TurnRight] != 0.0f)
+        RotateRight(input.Axes[PlayerInputFrame::TurnRight]);
+    if (input.Axes[PlayerInputFrame::TurnUp] != 0.0f)
+        RotateUp(input.Axes[PlayerInputFrame::TurnUp]);
+    if (input.Axes[PlayerInputFrame::FreelookHorizontal] != 0.0f)
+        FreelookHorizontal(input.Axes[PlayerInputFrame::FreelookHorizontal]);
+    if (input.Axes[PlayerInputFrame::FreelookVertical] != 0.0f)
+        FreelookVertical(input.Axes[PlayerInputFrame::FreelookVertical]);
+
+    if (input.Actions & PLAYER_INPUT_ATTACK)
+        Attack();
+    if (input.Actions & PLAYER_INPUT_SWITCH_WEAPON)
+        SwitchWeapon();
+}
+
 void FirstPersonComponent::MoveForward(float amount)
 {
+    m_RecordedInput.Axes[PlayerInputFrame::MoveForward] = amount;
     m_MoveForward = amount;
 }
 
 void FirstPersonComponent::MoveRight(float amount)
 {
+    m_RecordedInput.Axes[PlayerInputFrame::MoveRight] = amount;
     m_MoveRight = amount;
 }
 
 void FirstPersonComponent::TurnRight(float amount)
 {
-    if (auto viewPoint = GetViewPoint())
-        viewPoint->Rotate(-amount * GetWorld()->GetTick().FrameTimeStep, Float3::sAxisY());
+    RotateRight(amount * GetWorld()->GetTick().FrameTimeStep);
 }
 
 void FirstPersonComponent::TurnUp(float amount)
 {
+    RotateUp(amount * GetWorld()->GetTick().FrameTimeStep);
+}
+
+void FirstPersonComponent::RotateRight(float angle)
+{
+    m_RecordedInput.Axes[PlayerInputFrame::TurnRight] += angle;
+
     if (auto viewPoint = GetViewPoint())
-        viewPoint->Rotate(amount * GetWorld()->GetTick().FrameTimeStep, viewPoint->GetRightVector());
+        viewPoint->Rotate(-angle, Float3::sAxisY());
+}
+
+void FirstPersonComponent::RotateUp(float angle)
+{
+    m_RecordedInput.Axes[PlayerInputFrame::TurnUp] += angle;
+
+    if (auto viewPoint = GetViewPoint())
+        viewPoint->Rotate(angle, viewPoint->GetRightVector());
 }
 
 void FirstPersonComponent::FreelookHorizontal(float amount)
 {
+    m_RecordedInput.Axes[PlayerInputFrame::FreelookHorizontal] += amount;
+
     if (auto viewPoint = GetViewPoint())
         viewPoint->Rotate(-amount, Float3::sAxisY());
 }
 
 void FirstPersonComponent::FreelookVertical(float amount)
 {
+    m_RecordedInput.Axes[PlayerInputFrame::FreelookVertical] += amount;
+
     if (auto viewPoint = GetViewPoint())
         viewPoint->Rotate(amount, viewPoint->GetRightVector());
 }
 
 void FirstPersonComponent::Attack()
 {
+    m_RecordedInput.Actions |= PLAYER_INPUT_ATTACK;
+
     if (auto viewPoint = GetViewPoint())
     {
         Float3 p = GetOwner()->GetWorldPosition();
         Float3 dir = viewPoint->GetWorldDirection();
-        const float Impulse = 100;
         p.Y += EyeHeight;
         p += dir;
-        SpawnProjectile(GetWorld(), p, dir * Impulse, Team);
+
+        if (Weapon == WeaponMode::Hitscan)
+        {
+            const float Range = 200;
+            const float Impulse = 5;
+            GetWorld()->GetInterface<HitscanInterface>().Fire(p, dir, Range, Impulse, Team);
+        }
+        else
+        {
+            const float Impulse = 100;
+            SpawnProjectile(GetWorld(), p, dir * Impulse, Team);
+        }
     }
 }
 
+void FirstPersonComponent::SwitchWeapon()
+{
+    m_RecordedInput.Actions |= PLAYER_INPUT_SWITCH_WEAPON;
+
+    Weapon = Weapon == WeaponMode::Projectile ? WeaponMode::Hitscan : WeaponMode::Projectile;
+}
+
 void FirstPersonComponent::MoveUp(float amount)
 {
+    m_RecordedInput.Axes[PlayerInputFrame::MoveUp] = amount;
     m_Jump = amount != 0.0f;
 }
 
@@ -111,7 +187,17 @@ GameObject* FirstPersonComponent::GetViewPoint()
     return GetWorld()->GetObject(ViewPoint);
 }
 
-void FirstPersonComponent::FixedUpdate()
+void FirstPersonComponent::BeginPlay()
+{
+    m_ParallelTick = GetWorld()->GetInterface<ParallelTickInterface>().Add(this);
+}
+
+void FirstPersonComponent::EndPlay()
+{
+    GetWorld()->GetInterface<ParallelTickInterface>().Remove(m_ParallelTick);
+}
+
+void FirstPersonComponent::ParallelFixedUpdate(CommandBuffer& commands)
 {
     auto controller = GetOwner()->GetComponent<CharacterControllerComponent>();
     if (!controller)
@@ -169,7 +255,7 @@ void FirstPersonComponent::FixedUpdate()
     newVelocity += m_DesiredVelocity;
 
     // Update character velocity
-    controller->SetLinearVelocity(newVelocity);
+    commands.SetLinearVelocity(GetOwner()->GetHandle(), newVelocity);
 }
 
 void FirstPersonComponent::ApplyDamage(Float3 const& damageVector)
@@ -32,11 +32,22 @@ SOFTWARE.
 
 #include <Hork/World/Component.h>
 #include <Hork/World/Modules/Input/InputBindings.h>
+#include "../Interfaces/ParallelTickInterface.h"
+#include "../InputRecording.h"
 #include <Hork/World/Modules/Physics/PhysicsInterface.h>
 #include "PlayerTeam.h"
 
 HK_NAMESPACE_BEGIN
 
+enum class WeaponMode
+{
+    // Physics projectile, see SpawnProjectile
+    Projectile,
+
+    // Instant hit, see HitscanInterface
+    Hitscan
+};
+
 class FirstPersonComponent : public Component
 {
 public:
@@ -46,11 +57,23 @@ public:
     float               JumpSpeed = 4;
     GameObjectHandle    ViewPoint;
     PlayerTeam          Team;
+    WeaponMode          Weapon = WeaponMode::Projectile;
 
     void                BindInput(InputBindings& input);
+
+    // Input received since the last fixed tick, for InputRecorder
+    PlayerInputFrame    TakeRecordedInput();
+
+    // Feeds recorded input through the same handlers as live input
+    void                ReplayInput(PlayerInputFrame const& input);
+
     void                ApplyDamage(Float3 const& damageVector);
 
-    void                FixedUpdate();
+    void                BeginPlay();
+    void                EndPlay();
+
+    // Runs on the job pool, see ParallelTickInterface
+    void                ParallelFixedUpdate(CommandBuffer& commands);
     void                PhysicsUpdate();
 
 private:
@@ -58,15 +81,20 @@ private:
     void                MoveRight(float amount);
     void                TurnRight(float amount);
     void                TurnUp(float amount);
+    void                RotateRight(float angle);
+    void                RotateUp(float angle);
     void                FreelookHorizontal(float amount);
     void                FreelookVertical(float amount);
     void                Attack();
+    void                SwitchWeapon();
     void                MoveUp(float amount);
     GameObject*         GetViewPoint();
 
     float               m_MoveForward = 0;
     float               m_MoveRight = 0;
     bool                m_Jump = false;
+    ParallelTickID      m_ParallelTick{};
+    PlayerInputFrame    m_RecordedInput;
     Float3              m_DesiredVelocity;
     float               m_ViewY = 0;
 };
@@ -32,8 +32,12 @@ SOFTWARE.
 
 #include <Hork/World/World.h>
 
+#include "../Interfaces/TimerInterface.h"
+#include "../Interfaces/DestructionInterface.h"
+
 using namespace Hk;
 
+// Destroys the owner after Time seconds. The expiration is scheduled once, the component doesn't tick.
 class LifeSpanComponent : public Component
 {
 public:
@@ -41,10 +45,22 @@ public:
 
     float Time = 0;
 
-    void FixedUpdate()
+    void BeginPlay()
+    {
+        World* world = GetWorld();
+        GameObjectHandle owner = GetOwner()->GetHandle();
+
+        m_Timer = world->GetInterface<TimerInterface>().Schedule(Time, [world, owner]()
+        {
+            world->GetInterface<DestructionInterface>().Destroy(owner);
+        });
+    }
+
+    void EndPlay()
     {
-        Time -= GetWorld()->GetTick().FixedTimeStep;
-        if (Time < 0)
-            GetWorld()->DestroyObject(GetOwner());
+        GetWorld()->GetInterface<TimerInterface>().Cancel(m_Timer);
     }
+
+private:
+    TimerID m_Timer{};
 };
@@ -30,19 +30,13 @@ SOFTWARE.
 
 #pragma once
 
-#include <Hork/World/Modules/Render/Components/PunctualLightComponent.h>
+#include "../Interfaces/LightStyleInterface.h"
 
 HK_NAMESPACE_BEGIN
 
-HK_FORCEINLINE float Quantize(float frac, float quantizer)
-{
-    return quantizer > 0.0f ? Math::Floor(frac * quantizer) / quantizer : frac;
-}
-
+// Animates the brightness of the owner's light. The animation is evaluated by LightStyleInterface.
 class LightAnimator : public Component
 {
-    Handle32<PunctualLightComponent> m_Light;
-
 public:
     static constexpr ComponentMode Mode = ComponentMode::Static;
 
@@ -69,86 +63,27 @@ public:
 
     void BeginPlay()
     {
-        m_Light = GetOwner()->GetComponentHandle<PunctualLightComponent>();
+        auto& lightStyles = GetWorld()->GetInterface<LightStyleInterface>();
+
+        // Type may come from map data. Unknown types get a constant normal brightness.
+        int style;
+        if (Type == CustomSequence)
+            style = lightStyles.RegisterStyle(Sequence);
+        else if (int(Type) >= 0 && int(Type) < LightStyleInterface::BuiltinStyleCount)
+            style = int(Type);
+        else
+            style = lightStyles.RegisterStyle("m");
+
+        m_Animator = lightStyles.AddAnimator(GetOwner()->GetComponentHandle<PunctualLightComponent>(), style, TimeOffset);
     }
 
-    void Update()
+    void EndPlay()
     {
-        if (auto lightComponent = GetWorld()->GetComponent(m_Light))
-        {
-            StringView sequence;
-            switch (Type)
-            {
-            case Flicker1:
-                sequence = "mmnmmommommnonmmonqnmmo";
-                break;
-            case SlowStrongPulse:
-                sequence = "abcdefghijklmnopqrstuvwxyzyxwvutsrqponmlkjihgfedcba";
-                break;
-            case Candle:
-                sequence = "mmmmmaaaaammmmmaaaaaabcdefgabcdefg";
-                break;
-            case FastStrobe:
-                sequence = "mamamamamama";
-                break;
-            case GentlePulse:
-                sequence = "jklmnopqrstuvwxyzyxwvutsrqponmlkj";
-                break;
-            case Flicker2:
-                sequence = "nmonqnmomnmomomno";
-                break;
-            case Candle2:
-                sequence = "mmmaaaabcdefgmmmmaaaammmaamm";
-                break;
-            case Candle3:
-                sequence = "mmmaaammmaaammmabcdefaaaammmmabcdefmmmaaaa";
-                break;
-            case SlowStrobe:
-                sequence = "aaaaaaaazzzzzzzz";
-                break;
-            case FluorescentFlicker:
-                sequence = "mmamammmmammamamaaamammma";
-                break;
-            case SlowPulse:
-                sequence = "abcdefghijklmnopqrrqponmlkjihgfedcba";
-                break;
-            case CustomSequence:
-                sequence = Sequence;
-                break;
-            default:
-                sequence = "m";
-                break;
-            }
-
-            float speed = 10;
-            float brightness = GetBrightness(sequence, TimeOffset + GetWorld()->GetTick().FrameTime * speed, 0);
-            lightComponent->SetColor(Float3(brightness));
-        }        
+        GetWorld()->GetInterface<LightStyleInterface>().RemoveAnimator(m_Animator);
     }
 
 private:
-    // Converts string to brightness: 'a' = no light, 'z' = double bright
-    float GetBrightness(StringView sequence, float position, float quantizer = 0)
-    {
-        int frameCount = sequence.Size();
-        if (frameCount > 0)
-        {
-            int keyframe = Math::Floor(position);
-            int nextframe = keyframe + 1;
-
-            float lerp = position - keyframe;
-
-            keyframe %= frameCount;
-            nextframe %= frameCount;
-
-            float a = (Math::Clamp(sequence[keyframe], 'a', 'z') - 'a') / 26.0f;
-            float b = (Math::Clamp(sequence[nextframe], 'a', 'z') - 'a') / 26.0f;
-
-            return Math::Lerp(a, b, Quantize(lerp, quantizer)) * 2;
-        }
-
-        return 1.0f;
-    }
+    LightAnimatorID m_Animator{};
 };
 
 HK_NAMESPACE_END
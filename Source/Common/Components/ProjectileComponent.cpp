@@ -30,34 +30,50 @@ SOFTWARE.
 
 #include "ProjectileComponent.h"
 #include "FirstPersonComponent.h"
-#include "LifeSpanComponent.h"
-#include "../CollisionLayer.h"
-
-#include <Hork/World/Modules/Physics/Components/DynamicBodyComponent.h>
-#include <Hork/World/Modules/Render/Components/MeshComponent.h>
-#include <Hork/GameApplication/GameApplication.h>
+#include "../Interfaces/ProjectileInterface.h"
+#include "../Interfaces/ExplosionInterface.h"
 
 HK_NAMESPACE_BEGIN
 
+void ProjectileComponent::Explode(Float3 const& position, GameObjectHandle directHit)
+{
+    auto& projectiles = GetWorld()->GetInterface<ProjectileInterface>();
+
+    // Several contacts may be reported in one step
+    if (!projectiles.IsActive(PoolSlot))
+        return;
+
+    GetWorld()->GetInterface<ExplosionInterface>().Explode(position, SplashRadius, SplashImpulse, Team, directHit);
+
+    projectiles.Release(PoolSlot);
+}
+
 void ProjectileComponent::OnBeginContact(Collision& collision)
 {
+    //LOG("BEGIN  Projectile contact with {} normal {} num points {} depth {}\n", collision.Body->GetOwner()->GetName(), collision.Normal, collision.Contacts.Size(), collision.Depth);
+
+    GameObjectHandle directHit;
+
     if (auto gameObject = collision.Body->GetOwner())
     {
         if (auto pawn = gameObject->GetComponent<FirstPersonComponent>())
         {
-            if (pawn->Team != Team)
-            {
-                //LOG("BEGIN  Projectile contact with {} normal {} num points {} depth {}\n", collision.Body->GetOwner()->GetName(), collision.Normal, collision.Contacts.Size(), collision.Depth);
-
-                m_Contact = collision.Contacts[0].PositionSelf;
-                m_Normal = collision.Normal;
+            // Passes through teammates
+            if (pawn->Team == Team)
+                return;
 
-                pawn->ApplyDamage(collision.Contacts[0].VelocitySelf);
-
-                GetWorld()->DestroyObject(GetOwner());
-            }
+            // The hit player takes the direct damage instead of the splash
+            pawn->ApplyDamage(collision.Contacts[0].VelocitySelf);
+            directHit = gameObject->GetHandle();
         }
     }
+
+    m_Contact = collision.Contacts[0].PositionSelf;
+    m_Normal = collision.Normal;
+
+    // The contact lies on the surface that was hit, so a ray cast from it would start inside the geometry
+    // and block the splash. The center of the projectile is still in front of the surface.
+    Explode(GetOwner()->GetWorldPosition(), directHit);
 }
 
 void ProjectileComponent::OnUpdateContact(Collision& collision)
@@ -86,40 +102,7 @@ void ProjectileComponent::DrawDebug(DebugRenderer& renderer)
 
 void SpawnProjectile(World* world, Float3 const& position, Float3 const& impulse, PlayerTeam team)
 {
-    auto& resourceMngr = GameApplication::sGetResourceManager();
-    auto& materialMngr = GameApplication::sGetMaterialManager();
-
-    static auto meshResource = resourceMngr.GetResource<MeshResource>("/Root/default/sphere.mesh");
-
-    GameObjectDesc desc;
-    desc.Name.FromString("Projectile");
-    desc.Position = position;
-    desc.Scale = Float3(0.2f);
-    desc.IsDynamic = true;
-    GameObject* object;
-    world->CreateObject(desc, object);
-    DynamicBodyComponent* phys;
-    object->CreateComponent(phys);
-    phys->CollisionLayer = CollisionLayer::Bullets;
-    phys->UseCCD = true;
-    phys->DispatchContactEvents = true;
-    phys->CanPushCharacter = false;
-    phys->Material.Restitution = 0.3f;
-    phys->AddImpulse(impulse);
-    SphereCollider* collider;
-    object->CreateComponent(collider);
-    collider->Radius = 0.5f;
-    DynamicMeshComponent* mesh;
-    object->CreateComponent(mesh);
-    mesh->SetMesh(meshResource);
-    mesh->SetMaterial(materialMngr.TryGet(team == PlayerTeam::Blue ? "blank512" : "red512"));
-    mesh->SetLocalBoundingBox({Float3(-0.5f),Float3(0.5f)});
-    LifeSpanComponent* lifespan;
-    object->CreateComponent(lifespan);
-    lifespan->Time = 2;
-    ProjectileComponent* projectile;
-    object->CreateComponent(projectile);
-    projectile->Team = team;
+    world->GetInterface<ProjectileInterface>().Spawn(position, impulse, team);
 }
 
 HK_NAMESPACE_END
@@ -43,6 +43,17 @@ public:
 
     PlayerTeam Team = PlayerTeam::Blue;
 
+    // Splash damage around the impact point
+    float SplashRadius = 3;
+    float SplashImpulse = 4;
+
+    // Slot in ProjectileInterface
+    uint32_t PoolSlot = 0;
+
+    // Requests the splash at the position and returns the projectile to the pool.
+    // The directly hit object is excluded from the splash.
+    void Explode(Float3 const& position, GameObjectHandle directHit = {});
+
     void OnBeginContact(Collision& collision);
 
     void OnUpdateContact(Collision& collision);
@@ -56,6 +67,7 @@ private:
     Float3 m_Normal;
 };
 
+// Takes a projectile from the world's ProjectileInterface pool
 void SpawnProjectile(World* world, Float3 const& position, Float3 const& impulse, PlayerTeam team);
 
 HK_NAMESPACE_END
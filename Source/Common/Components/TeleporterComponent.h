@@ -34,7 +34,8 @@ SOFTWARE.
 #include <Hork/World/Modules/Physics/Components/DynamicBodyComponent.h>
 #include <Hork/World/Modules/Render/Components/CameraComponent.h>
 #include <Hork/World/Modules/Render/Components/MeshComponent.h>
-#include <Hork/GameApplication/GameApplication.h>
+
+#include "../Interfaces/RandomInterface.h"
 
 using namespace Hk;
 
@@ -53,7 +54,7 @@ public:
 
     void OnBeginOverlap(BodyComponent* body)
     {
-        auto& dest = TeleportPoints[GameApplication::sGetRandom().Get() & 1];
+        auto& dest = TeleportPoints[GetWorld()->GetInterface<RandomInterface>().Get() & 1];
 
         if (auto character = sUpcast<CharacterControllerComponent>(body))
         {
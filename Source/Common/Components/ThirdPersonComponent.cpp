@@ -52,42 +52,96 @@ void ThirdPersonComponent::BindInput(InputBindings& input)
     input.BindAxis("MoveUp", this, &ThirdPersonComponent::MoveUp);
 }
 
+PlayerInputFrame ThirdPersonComponent::TakeRecordedInput()
+{
+    PlayerInputFrame input = m_RecordedInput;
+
+    // Move axes keep their value until the next input event, rotations and actions are consumed
+    for (int axis = PlayerInputFrame::TurnRight; axis < PlayerInputFrame::AxisCount; ++axis)
+        m_RecordedInput.Axes[axis] = 0;
+    m_RecordedInput.Actions = 0;
+
+    return input;
+}
+
+void ThirdPersonComponent::ReplayInput(PlayerInputFrame const& input)
+{
+    MoveForward(input.Axes[PlayerInputFrame::MoveForward]);
+    MoveRight(input.Axes[PlayerInputFrame::MoveRight]);
+    MoveUp(input.Axes[PlayerInputFrame::MoveUp]);
+
+    // Rotations are recorded as the angle of the tick, zero means the axis wasn't touched
+    if (input.Axes[PlayerInputFrame::TurnRight] != 0.0f)
+        RotateRight(input.Axes[PlayerInputFrame::TurnRight]);
+    if (input.Axes[PlayerInputFrame::TurnUp] != 0.0f)
+        RotateUp(input.Axes[PlayerInputFrame::TurnUp]);
+    if (input.Axes[PlayerInputFrame::FreelookHorizontal] != 0.0f)
+        FreelookHorizontal(input.Axes[PlayerInputFrame::FreelookHorizontal]);
+    if (input.Axes[PlayerInputFrame::FreelookVertical] != 0.0f)
+        FreelookVertical(input.Axes[PlayerInputFrame::FreelookVertical]);
+
+    if (input.Actions & PLAYER_INPUT_ATTACK)
+        Attack();
+}
+
 void ThirdPersonComponent::MoveForward(float amount)
 {
+    m_RecordedInput.Axes[PlayerInputFrame::MoveForward] = amount;
     m_MoveForward = amount;
 }
 
 void ThirdPersonComponent::MoveRight(float amount)
 {
+    m_RecordedInput.Axes[PlayerInputFrame::MoveRight] = amount;
     m_MoveRight = amount;
 }
 
 void ThirdPersonComponent::TurnRight(float amount)
 {
-    if (auto viewPoint = GetWorld()->GetObject(ViewPoint))
-        viewPoint->Rotate(-amount * GetWorld()->GetTick().FrameTimeStep, Float3::sAxisY());
+    RotateRight(amount * GetWorld()->GetTick().FrameTimeStep);
 }
 
 void ThirdPersonComponent::TurnUp(float amount)
 {
+    RotateUp(amount * GetWorld()->GetTick().FrameTimeStep);
+}
+
+void ThirdPersonComponent::RotateRight(float angle)
+{
+    m_RecordedInput.Axes[PlayerInputFrame::TurnRight] += angle;
+
     if (auto viewPoint = GetWorld()->GetObject(ViewPoint))
-        viewPoint->Rotate(amount * GetWorld()->GetTick().FrameTimeStep, viewPoint->GetRightVector());
+        viewPoint->Rotate(-angle, Float3::sAxisY());
+}
+
+void ThirdPersonComponent::RotateUp(float angle)
+{
+    m_RecordedInput.Axes[PlayerInputFrame::TurnUp] += angle;
+
+    if (auto viewPoint = GetWorld()->GetObject(ViewPoint))
+        viewPoint->Rotate(angle, viewPoint->GetRightVector());
 }
 
 void ThirdPersonComponent::FreelookHorizontal(float amount)
 {
+    m_RecordedInput.Axes[PlayerInputFrame::FreelookHorizontal] += amount;
+
     if (auto viewPoint = GetWorld()->GetObject(ViewPoint))
         viewPoint->Rotate(-amount, Float3::sAxisY());
 }
 
 void ThirdPersonComponent::FreelookVertical(float amount)
 {
+    m_RecordedInput.Axes[PlayerInputFrame::FreelookVertical] += amount;
+
     if (auto viewPoint = GetWorld()->GetObject(ViewPoint))
         viewPoint->Rotate(amount, viewPoint->GetRightVector());
 }
 
 void ThirdPersonComponent::Attack()
 {
+    m_RecordedInput.Actions |= PLAYER_INPUT_ATTACK;
+
     if (auto viewPoint = GetWorld()->GetObject(ViewPoint))
     {
         Float3 p = GetOwner()->GetWorldPosition();
@@ -102,10 +156,21 @@ void ThirdPersonComponent::Attack()
 
 void ThirdPersonComponent::MoveUp(float amount)
 {
+    m_RecordedInput.Axes[PlayerInputFrame::MoveUp] = amount;
     m_Jump = amount != 0.0f;
 }
 
-void ThirdPersonComponent::FixedUpdate()
+void ThirdPersonComponent::BeginPlay()
+{
+    m_ParallelTick = GetWorld()->GetInterface<ParallelTickInterface>().Add(this);
+}
+
+void ThirdPersonComponent::EndPlay()
+{
+    GetWorld()->GetInterface<ParallelTickInterface>().Remove(m_ParallelTick);
+}
+
+void ThirdPersonComponent::ParallelFixedUpdate(CommandBuffer& commands)
 {
     auto controller = GetOwner()->GetComponent<CharacterControllerComponent>();
     if (!controller)
@@ -163,7 +228,7 @@ void ThirdPersonComponent::FixedUpdate()
     newVelocity += m_DesiredVelocity;
 
     // Update character velocity
-    controller->SetLinearVelocity(newVelocity);
+    commands.SetLinearVelocity(GetOwner()->GetHandle(), newVelocity);
 }
 
 HK_NAMESPACE_END
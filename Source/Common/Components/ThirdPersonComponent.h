@@ -32,6 +32,8 @@ SOFTWARE.
 
 #include <Hork/World/Component.h>
 #include <Hork/World/Modules/Input/InputBindings.h>
+#include "../Interfaces/ParallelTickInterface.h"
+#include "../InputRecording.h"
 
 HK_NAMESPACE_BEGIN
 
@@ -46,7 +48,19 @@ public:
     //Handle32<CameraComponent> Camera;
 
     void BindInput(InputBindings& input);
-    void FixedUpdate();
+
+    // Input received since the last fixed tick, for InputRecorder
+    PlayerInputFrame TakeRecordedInput();
+
+    // Feeds recorded input through the same handlers as live input
+    void ReplayInput(PlayerInputFrame const& input);
+
+    void BeginPlay();
+
+    void EndPlay();
+
+    // Runs on the job pool, see ParallelTickInterface
+    void ParallelFixedUpdate(CommandBuffer& commands);
 
 private:
 
@@ -58,6 +72,10 @@ private:
 
     void TurnUp(float amount);
 
+    void RotateRight(float angle);
+
+    void RotateUp(float angle);
+
     void FreelookHorizontal(float amount);
 
     void FreelookVertical(float amount);
@@ -69,6 +87,8 @@ private:
     float   m_MoveForward = 0;
     float   m_MoveRight = 0;
     bool    m_Jump = false;
+    ParallelTickID m_ParallelTick{};
+    PlayerInputFrame m_RecordedInput;
     Float3  m_DesiredVelocity;
 };
 
@@ -55,6 +55,10 @@ public:
     }
 };
 
+The command line is passed to the application as ArgumentPack. Samples that support it run without UI and
+world render views when started with -headless, see HeadlessRunner.h. The window and the render device are
+created by GameApplication in any case.
+
 */
 
 alignas(alignof(ApplicationClass)) static char AppData[sizeof(ApplicationClass)];
@@ -0,0 +1,264 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "HeadlessRunner.h"
+#include "MemoryTags.h"
+#include "Interfaces/TickCounterInterface.h"
+
+#include <Hork/Core/Logger.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+HK_NAMESPACE_BEGIN
+
+namespace
+{
+    struct Timings
+    {
+        float Avg = 0;
+        float Min = 0;
+        float P50 = 0;
+        float P95 = 0;
+        float P99 = 0;
+        float Max = 0;
+    };
+
+    Timings CalcTimings(Vector<float> values)
+    {
+        Timings timings;
+        if (values.IsEmpty())
+            return timings;
+
+        std::sort(values.begin(), values.end());
+
+        auto percentile = [&values](float p)
+        {
+            return values[Math::Min(int(p * values.Size()), int(values.Size()) - 1)];
+        };
+
+        float sum = 0;
+        for (float value : values)
+            sum += value;
+
+        timings.Avg = sum / values.Size();
+        timings.Min = values[0];
+        timings.P50 = percentile(0.5f);
+        timings.P95 = percentile(0.95f);
+        timings.P99 = percentile(0.99f);
+        timings.Max = values.Last();
+        return timings;
+    }
+
+    void WriteTimings(FILE* file, const char* indent, Timings const& timings)
+    {
+        fprintf(file, "{\n%s  \"avg_ms\": %.4f,\n%s  \"p50_ms\": %.4f,\n%s  \"p95_ms\": %.4f,\n%s  \"p99_ms\": %.4f,\n%s  \"max_ms\": %.4f\n%s}",
+                indent, timings.Avg, indent, timings.P50, indent, timings.P95, indent, timings.P99, indent, timings.Max, indent);
+    }
+}
+
+HeadlessRunner::HeadlessRunner(ArgumentPack const& args) :
+    m_CreateTime(Clock::now())
+{
+    m_Enabled = args.Find("-headless") != -1;
+    m_Unlocked = args.Find("-unlocked") != -1;
+    m_Render = args.Find("-render") != -1;
+    m_Scripted = args.Find("-script") != -1;
+
+    int i = args.Find("-ticks");
+    if (i != -1 && i + 1 < args.Size())
+        m_TickCount = Math::Max(std::atoi(args.At(i + 1)), 1);
+
+    i = args.Find("-perf");
+    if (i != -1 && i + 1 < args.Size())
+        m_PerfFile = args.At(i + 1);
+}
+
+void HeadlessRunner::Start(World* world)
+{
+    // The frame limit only changes how often frames run, the world ticks at its fixed rate either way
+    GameApplication::sGetCommandProcessor().Add(m_Unlocked ? "com_MaxFPS 0\n" : "com_MaxFPS 60\n");
+
+    Attach(world);
+
+    m_TickTimes.Clear();
+    m_TickTimes.Reserve(m_TickCount);
+    m_StartTime = m_LastTime = Clock::now();
+    m_StartCycles = m_LastCycles = TickStats::sReadCycles();
+    m_LastTickNum = TickCounterInterface::sGetTickNum();
+    m_Started = true;
+
+    // Loading cost of the tick groups is not part of the run
+    m_Phases.Clear();
+    SamplePhases(1, 1);
+    for (Phase& phase : m_Phases)
+        phase.TickCycles.Clear();
+
+    LOG("Headless run: {} ticks{}{}{}\n", m_TickCount, m_Unlocked ? ", unlocked" : "", m_Render ? ", rendering" : "", m_Scripted ? ", scripted input" : "");
+}
+
+void HeadlessRunner::Attach(World* world)
+{
+    world->GetInterface<TickCounterInterface>();
+}
+
+bool HeadlessRunner::Update()
+{
+    if (!m_Started)
+        return false;
+
+    // Frames without a tick add their time to the next tick
+    uint64_t tickNum = TickCounterInterface::sGetTickNum();
+    int ticks = int(tickNum - m_LastTickNum);
+    if (ticks == 0)
+        return false;
+    m_LastTickNum = tickNum;
+
+    auto now = Clock::now();
+    float tickTime = std::chrono::duration<float, std::milli>(now - m_LastTime).count() / ticks;
+    for (int i = 0; i < ticks; ++i)
+        m_TickTimes.Add(tickTime);
+    m_LastTime = now;
+    m_LastCycles = TickStats::sReadCycles();
+
+    SamplePhases(m_TickTimes.Size(), ticks);
+
+    if (m_TickTimes.Size() < m_TickCount)
+        return false;
+
+    PrintSummary();
+    if (!m_PerfFile.IsEmpty())
+        WritePerf();
+
+    m_Started = false;
+    return true;
+}
+
+void HeadlessRunner::SamplePhases(int tickCount, int ticks)
+{
+    TickStats::sGet().GetEntries(m_Entries);
+
+    for (Phase& phase : m_Phases)
+        phase.TotalCycles = 0;
+
+    for (TickStats::Entry const* entry : m_Entries)
+    {
+        auto it = std::find_if(m_Phases.begin(), m_Phases.end(), [entry](Phase const& phase) { return !strcmp(phase.Name, entry->GroupName); });
+        if (it == m_Phases.end())
+        {
+            // A group that first ticked now; its earlier ticks were empty
+            Phase& phase = m_Phases.EmplaceBack();
+            phase.Name = entry->GroupName;
+            phase.LastCycles = 0;
+            phase.TotalCycles = 0;
+            phase.TickCycles.Resize(tickCount - ticks);
+            for (uint64_t& cycles : phase.TickCycles)
+                cycles = 0;
+            it = m_Phases.end() - 1;
+        }
+        // Cycles since startup, the difference is taken below
+        it->TotalCycles += entry->Cycles.load(std::memory_order_relaxed);
+    }
+
+    for (Phase& phase : m_Phases)
+    {
+        uint64_t cycles = (phase.TotalCycles - phase.LastCycles) / ticks;
+        for (int i = 0; i < ticks; ++i)
+            phase.TickCycles.Add(cycles);
+        phase.LastCycles = phase.TotalCycles;
+    }
+}
+
+void HeadlessRunner::PrintSummary() const
+{
+    float totalSeconds = std::chrono::duration<float>(m_LastTime - m_StartTime).count();
+
+    Timings timings = CalcTimings(m_TickTimes);
+
+    LOG("Headless run finished: {} ticks in {} s ({} ticks/s)\n", m_TickTimes.Size(), totalSeconds, totalSeconds > 0 ? m_TickTimes.Size() / totalSeconds : 0.0f);
+    LOG("  tick ms: avg {} min {} p50 {} p95 {} p99 {} max {}\n",
+        timings.Avg, timings.Min, timings.P50, timings.P95, timings.P99, timings.Max);
+}
+
+void HeadlessRunner::WritePerf() const
+{
+    FILE* file = fopen(m_PerfFile.CStr(), "w");
+    if (!file)
+    {
+        LOG("Failed to write {}\n", m_PerfFile);
+        return;
+    }
+
+    double runMs = std::chrono::duration<double, std::milli>(m_LastTime - m_StartTime).count();
+    double msPerCycle = m_LastCycles > m_StartCycles ? runMs / (m_LastCycles - m_StartCycles) : 0;
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"ticks\": %d,\n", int(m_TickTimes.Size()));
+    fprintf(file, "  \"unlocked\": %s,\n", m_Unlocked ? "true" : "false");
+    fprintf(file, "  \"render\": %s,\n", m_Render ? "true" : "false");
+    fprintf(file, "  \"scripted\": %s,\n", m_Scripted ? "true" : "false");
+    fprintf(file, "  \"load_ms\": %.3f,\n", std::chrono::duration<double, std::milli>(m_StartTime - m_CreateTime).count());
+    fprintf(file, "  \"run_ms\": %.3f,\n", runMs);
+
+    fprintf(file, "  \"tick\": ");
+    WriteTimings(file, "  ", CalcTimings(m_TickTimes));
+    fprintf(file, ",\n");
+
+    // Tick functions of a group may run on several threads, so a phase can take longer than the tick
+    fprintf(file, "  \"phases\": {");
+    Vector<float> phaseTimes;
+    for (int i = 0; i < m_Phases.Size(); ++i)
+    {
+        Phase const& phase = m_Phases[i];
+
+        phaseTimes.Clear();
+        for (uint64_t cycles : phase.TickCycles)
+            phaseTimes.Add(float(cycles * msPerCycle));
+
+        fprintf(file, "%s\n    \"%s\": ", i ? "," : "", phase.Name);
+        WriteTimings(file, "    ", CalcTimings(phaseTimes));
+    }
+    fprintf(file, "\n  },\n");
+
+    MemoryTracker& memory = MemoryTracker::sGet();
+    fprintf(file, "  \"memory\": {\n");
+    fprintf(file, "    \"peak_rss_mb\": %.3f,\n", MemoryTracker::sGetProcessPeakMemory() / (1024.0 * 1024.0));
+    fprintf(file, "    \"tracked_peak_mb\": %.3f\n", memory.GetPeak() / (1024.0 * 1024.0));
+    fprintf(file, "  }\n");
+    fprintf(file, "}\n");
+
+    fclose(file);
+
+    LOG("Performance results written to {}\n", m_PerfFile);
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,125 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/GameApplication/GameApplication.h>
+
+#include "TickStats.h"
+
+#include <chrono>
+
+HK_NAMESPACE_BEGIN
+
+// Simulation-only run of a sample, selected from the command line:
+//
+//     -headless            don't create the UI, viewports and world render views. GameApplication still opens
+//                          its window and render device, only the samples' views are left out, so a display
+//                          is still needed
+//     -ticks N             exit after N fixed world ticks (default 600)
+//     -unlocked            don't limit the frame rate. The world still runs its fixed ticks in real time,
+//                          so this measures the cost of the frames between ticks, not a faster simulation.
+//     -render              keep the viewports and world render views, so frames still go through
+//                          view setup, culling, draw list building and submission to the GPU
+//     -script              drive the players with scripted input, in samples that have players
+//     -perf FILE           write load time, tick time percentiles per tick group and peak memory to a JSON file
+//
+// The application calls Start() with its world when gameplay begins and Update() once per frame. Ticks are
+// the fixed ticks the world ran, counted by TickCounterInterface; a frame may run none or several of them,
+// and its time is split evenly between them. When the tick count is reached a timing summary is written
+// to the log. Load time is the time from the construction of the runner, together with the application,
+// to Start().
+class HeadlessRunner final
+{
+public:
+    explicit            HeadlessRunner(ArgumentPack const& args);
+
+    bool                IsEnabled() const { return m_Enabled; }
+
+    int                 GetTickCount() const { return m_TickCount; }
+    bool                IsUnlocked() const { return m_Unlocked; }
+
+    // True when the application should render frames. Always true in normal runs.
+    bool                IsRenderEnabled() const { return !m_Enabled || m_Render; }
+
+    // True when players should take scripted input instead of live input
+    bool                IsScripted() const { return m_Enabled && m_Scripted; }
+
+    // Sets the frame rate limit and starts the clock
+    void                Start(World* world);
+
+    // Counts the ticks of a world that replaces the one given to Start()
+    void                Attach(World* world);
+
+    // Returns true when all ticks are done and the application should exit
+    bool                Update();
+
+    // Ticks done since Start()
+    int                 GetTickNum() const { return m_TickTimes.Size(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Cycles of all tick functions of one tick group in every tick
+    struct Phase
+    {
+        const char*     Name;
+        uint64_t        LastCycles;
+        uint64_t        TotalCycles;
+        Vector<uint64_t> TickCycles;
+    };
+
+    // Splits the cycles since the last call between the ticks, so every phase has tickCount samples
+    void                SamplePhases(int tickCount, int ticks);
+    void                PrintSummary() const;
+    void                WritePerf() const;
+
+    bool                m_Enabled = false;
+    bool                m_Unlocked = false;
+    bool                m_Render = false;
+    bool                m_Scripted = false;
+    int                 m_TickCount = 600;
+    String              m_PerfFile;
+    bool                m_Started = false;
+    Clock::time_point   m_CreateTime;
+    Clock::time_point   m_StartTime;
+    Clock::time_point   m_LastTime;
+    uint64_t            m_StartCycles = 0;
+    uint64_t            m_LastCycles = 0;
+    uint64_t            m_LastTickNum = 0;
+
+    // Wall time of every tick in milliseconds
+    Vector<float>       m_TickTimes;
+
+    Vector<Phase>       m_Phases;
+    Vector<TickStats::Entry const*> m_Entries;
+};
+
+HK_NAMESPACE_END
@@ -0,0 +1,279 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "InputRecording.h"
+
+#include <Hork/Core/Logger.h>
+
+#include <cstdio>
+#include <cstring>
+
+HK_NAMESPACE_BEGIN
+
+namespace
+{
+    const uint32_t FileMagic = 0x5249484b; // "KHIR"
+    const uint32_t FileVersion = 2;
+
+    // Magic, version, seed, player count, tick count
+    const size_t HeaderSize = 5 * 4;
+
+    // The file is little-endian whatever the host is
+    void WriteUInt32(Vector<uint8_t>& stream, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            stream.Add(uint8_t(value >> (i * 8)));
+    }
+
+    void WriteFloat(Vector<uint8_t>& stream, float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, 4);
+        WriteUInt32(stream, bits);
+    }
+
+    uint32_t ReadUInt32(uint8_t const* bytes)
+    {
+        return uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) | (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+    }
+
+    float ReadFloat(uint8_t const* bytes)
+    {
+        uint32_t bits = ReadUInt32(bytes);
+        float value;
+        memcpy(&value, &bits, 4);
+        return value;
+    }
+}
+
+void InputRecorder::Begin(int playerCount, uint32_t seed)
+{
+    m_PlayerCount = playerCount;
+    m_Seed = seed;
+    m_TickCount = 0;
+    m_Frames.Clear();
+}
+
+void InputRecorder::NextTick()
+{
+    m_Frames.Resize(m_Frames.Size() + m_PlayerCount);
+    for (int i = 0; i < m_PlayerCount; ++i)
+        m_Frames[m_TickCount * m_PlayerCount + i] = {};
+    ++m_TickCount;
+}
+
+void InputRecorder::Record(int player, PlayerInputFrame const& input)
+{
+    HK_ASSERT(m_TickCount > 0);
+    m_Frames[(m_TickCount - 1) * m_PlayerCount + player] = input;
+}
+
+bool InputRecorder::Save(StringView filename) const
+{
+    FILE* file = fopen(String(filename).CStr(), "wb");
+    if (!file)
+    {
+        LOG("Failed to write input recording {}\n", filename);
+        return false;
+    }
+
+    Vector<uint8_t> stream;
+    stream.Reserve(HeaderSize + m_Frames.Size() * 2);
+
+    WriteUInt32(stream, FileMagic);
+    WriteUInt32(stream, FileVersion);
+    WriteUInt32(stream, m_Seed);
+    WriteUInt32(stream, m_PlayerCount);
+    WriteUInt32(stream, m_TickCount);
+
+    // Per tick and player: changed axes mask, actions, then the changed axes
+
+    for (int player = 0; player < m_PlayerCount; ++player)
+    {
+        PlayerInputFrame prev;
+        for (int tick = 0; tick < m_TickCount; ++tick)
+        {
+            PlayerInputFrame const& frame = m_Frames[tick * m_PlayerCount + player];
+
+            uint8_t mask = 0;
+            for (int axis = 0; axis < PlayerInputFrame::AxisCount; ++axis)
+                if (frame.Axes[axis] != prev.Axes[axis])
+                    mask |= 1 << axis;
+
+            stream.Add(mask);
+            stream.Add(frame.Actions);
+            for (int axis = 0; axis < PlayerInputFrame::AxisCount; ++axis)
+            {
+                if (mask & (1 << axis))
+                    WriteFloat(stream, frame.Axes[axis]);
+            }
+            prev = frame;
+        }
+    }
+
+    fwrite(stream.ToPtr(), 1, stream.Size(), file);
+    fclose(file);
+
+    LOG("Saved input recording {}: {} ticks, {} bytes\n", filename, m_TickCount, stream.Size());
+    return true;
+}
+
+bool InputReplay::Load(StringView filename)
+{
+    m_Frames.Clear();
+    m_Tick = m_TickCount = m_PlayerCount = 0;
+
+    FILE* file = fopen(String(filename).CStr(), "rb");
+    if (!file)
+    {
+        LOG("Failed to open input recording {}\n", filename);
+        return false;
+    }
+
+    Vector<uint8_t> stream;
+    uint8_t buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        size_t size = stream.Size();
+        stream.Resize(size + count);
+        memcpy(stream.ToPtr() + size, buffer, count);
+    }
+    fclose(file);
+
+    if (stream.Size() < HeaderSize || ReadUInt32(&stream[0]) != FileMagic || ReadUInt32(&stream[4]) != FileVersion)
+    {
+        LOG("Invalid input recording {}\n", filename);
+        return false;
+    }
+
+    uint32_t seed = ReadUInt32(&stream[8]);
+    uint32_t playerCount = ReadUInt32(&stream[12]);
+    uint32_t tickCount = ReadUInt32(&stream[16]);
+
+    m_Frames.Resize(tickCount * playerCount);
+
+    size_t offset = HeaderSize;
+    for (uint32_t player = 0; player < playerCount; ++player)
+    {
+        PlayerInputFrame prev;
+        for (uint32_t tick = 0; tick < tickCount; ++tick)
+        {
+            if (offset + 2 > stream.Size())
+            {
+                LOG("Truncated input recording {}\n", filename);
+                m_Frames.Clear();
+                return false;
+            }
+
+            uint8_t mask = stream[offset++];
+
+            PlayerInputFrame frame = prev;
+            frame.Actions = stream[offset++];
+            for (int axis = 0; axis < PlayerInputFrame::AxisCount; ++axis)
+            {
+                if (mask & (1 << axis))
+                {
+                    if (offset + 4 > stream.Size())
+                    {
+                        LOG("Truncated input recording {}\n", filename);
+                        m_Frames.Clear();
+                        return false;
+                    }
+                    frame.Axes[axis] = ReadFloat(&stream[offset]);
+                    offset += 4;
+                }
+            }
+
+            m_Frames[tick * playerCount + player] = frame;
+            prev = frame;
+        }
+    }
+
+    m_Seed = seed;
+    m_PlayerCount = playerCount;
+    m_TickCount = tickCount;
+
+    LOG("Loaded input recording {}: {} ticks, seed {}\n", filename, m_TickCount, m_Seed);
+    return true;
+}
+
+void InputReplay::Generate(int playerCount, int tickCount, uint32_t seed)
+{
+    m_PlayerCount = playerCount;
+    m_Seed = seed;
+    m_TickCount = tickCount;
+    m_Tick = 0;
+
+    m_Frames.Clear();
+    m_Frames.Resize(tickCount * playerCount);
+
+    // Fixed ticks per step
+    const int StepTicks = 120;
+
+    // Degrees per tick, turn axes hold the rotation of the tick
+    const float TurnAngle = 1.5f;
+
+    for (int player = 0; player < playerCount; ++player)
+    {
+        for (int tick = 0; tick < tickCount; ++tick)
+        {
+            PlayerInputFrame& frame = m_Frames[tick * playerCount + player];
+
+            // Players start at different steps, so they don't mirror each other
+            int stepTick = tick % StepTicks;
+            switch ((tick / StepTicks + player) % 4)
+            {
+                case 0:
+                    frame.Axes[PlayerInputFrame::MoveForward] = 1;
+                    break;
+                case 1:
+                    frame.Axes[PlayerInputFrame::MoveForward] = 1;
+                    frame.Axes[PlayerInputFrame::MoveRight] = (player & 1) ? -1.0f : 1.0f;
+                    frame.Axes[PlayerInputFrame::TurnRight] = (player & 1) ? TurnAngle : -TurnAngle;
+                    break;
+                case 2:
+                    frame.Axes[PlayerInputFrame::TurnRight] = TurnAngle;
+                    if (stepTick % 15 == 0)
+                        frame.Actions |= PLAYER_INPUT_ATTACK;
+                    break;
+                case 3:
+                    frame.Axes[PlayerInputFrame::MoveForward] = -1;
+                    if (stepTick < 10)
+                        frame.Axes[PlayerInputFrame::MoveUp] = 1;
+                    if (stepTick == StepTicks / 2)
+                        frame.Actions |= PLAYER_INPUT_SWITCH_WEAPON;
+                    break;
+            }
+        }
+    }
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,120 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/Core/Containers/Vector.h>
+#include <Hork/Core/String.h>
+
+HK_NAMESPACE_BEGIN
+
+enum PlayerInputAction : uint8_t
+{
+    PLAYER_INPUT_ATTACK         = 1 << 0,
+    PLAYER_INPUT_SWITCH_WEAPON  = 1 << 1
+};
+
+// Input a player component received during one fixed world tick. Move axes hold the state of the axis,
+// turn and freelook axes hold the view rotation of the tick in degrees.
+struct PlayerInputFrame
+{
+    enum
+    {
+        MoveForward,
+        MoveRight,
+        MoveUp,
+        TurnRight,
+        TurnUp,
+        FreelookHorizontal,
+        FreelookVertical,
+        AxisCount
+    };
+
+    float               Axes[AxisCount] = {};
+
+    // PlayerInputAction flags
+    uint8_t             Actions = 0;
+};
+
+// Records the input of several players fixed tick by fixed tick. The file stores only the axes that changed
+// since the previous tick of the same player, so idle input costs two bytes per player and tick.
+class InputRecorder final
+{
+public:
+    void                Begin(int playerCount, uint32_t seed);
+
+    // Starts a new tick. All players have empty input until Record is called.
+    void                NextTick();
+
+    void                Record(int player, PlayerInputFrame const& input);
+
+    bool                Save(StringView filename) const;
+
+    bool                IsRecording() const { return m_PlayerCount > 0; }
+    int                 GetPlayerCount() const { return m_PlayerCount; }
+    int                 GetTickCount() const { return m_TickCount; }
+
+private:
+    int                 m_PlayerCount = 0;
+    uint32_t            m_Seed = 0;
+    int                 m_TickCount = 0;
+    Vector<PlayerInputFrame> m_Frames;
+};
+
+// Plays back a file written by InputRecorder
+class InputReplay final
+{
+public:
+    bool                Load(StringView filename);
+
+    // Builds scripted input instead of loading a recording: each player runs, strafes in a circle, turns while
+    // shooting and backs off with a jump, 120 fixed ticks per step. Used for repeatable benchmark runs.
+    void                Generate(int playerCount, int tickCount, uint32_t seed);
+
+    uint32_t            GetSeed() const { return m_Seed; }
+    int                 GetPlayerCount() const { return m_PlayerCount; }
+    int                 GetTickCount() const { return m_TickCount; }
+
+    bool                IsFinished() const { return m_Tick >= m_TickCount; }
+
+    // Input of the current tick
+    PlayerInputFrame const& GetInput(int player) const { return m_Frames[m_Tick * m_PlayerCount + player]; }
+
+    void                NextTick() { ++m_Tick; }
+
+private:
+    int                 m_PlayerCount = 0;
+    uint32_t            m_Seed = 0;
+    int                 m_TickCount = 0;
+    int                 m_Tick = 0;
+    Vector<PlayerInputFrame> m_Frames;
+};
+
+HK_NAMESPACE_END
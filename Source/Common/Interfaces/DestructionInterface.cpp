@@ -0,0 +1,144 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "DestructionInterface.h"
+#include "../TraceProfiler.h"
+#include "../TickStats.h"
+
+#include <Hork/World/Modules/Physics/Components/CharacterControllerComponent.h>
+#include <Hork/World/Modules/Physics/Components/DynamicBodyComponent.h>
+#include <Hork/World/Modules/Physics/Components/StaticBodyComponent.h>
+
+#include <algorithm>
+
+HK_NAMESPACE_BEGIN
+
+DestructionInterface::DestructionInterface()
+{}
+
+void DestructionInterface::Initialize()
+{
+    TickFunction f;
+    f.Desc.Name.FromString("Destroy Objects");
+    f.Group = TickGroup::LateUpdate;
+    f.OwnerTypeID = GetInterfaceTypeID() | (1 << 31);
+    f.Delegate.Bind(this, &DestructionInterface::LateUpdate);
+    RegisterTickFunction(f);
+}
+
+void DestructionInterface::Deinitialize()
+{
+    // The objects go away with the world
+    for (Callback& callback : m_Callbacks)
+        callback();
+
+    m_Pending.Clear();
+    m_Batch.Clear();
+    m_Callbacks.Clear();
+}
+
+void DestructionInterface::Destroy(GameObjectHandle object)
+{
+    m_Pending.Add(object);
+}
+
+void DestructionInterface::OnDestroyed(Callback callback)
+{
+    m_Callbacks.Add(std::move(callback));
+}
+
+void DestructionInterface::LateUpdate()
+{
+    Flush();
+}
+
+void DestructionInterface::Flush()
+{
+    HK_TRACE_ZONE("LateUpdate/Destruction");
+    HK_TICK_COST("DestructionInterface", "LateUpdate");
+
+    // Callbacks may queue more objects, they are destroyed in the same call
+    while (!m_Pending.IsEmpty() || !m_Callbacks.IsEmpty())
+    {
+        DestroyPending();
+
+        Vector<Callback> callbacks = std::move(m_Callbacks);
+        m_Callbacks.Clear();
+
+        for (Callback& callback : callbacks)
+            callback();
+    }
+}
+
+void DestructionInterface::DestroyPending()
+{
+    World* world = GetWorld();
+
+    // Objects destroyed during the flush (from EndPlay) are queued again and handled in the same call
+    while (!m_Pending.IsEmpty())
+    {
+        m_Batch.Clear();
+        m_Batch.Reserve(m_Pending.Size());
+
+        for (GameObjectHandle handle : m_Pending)
+        {
+            GameObject* object = world->GetObject(handle);
+            if (!object)
+                continue;
+
+            Entry& entry = m_Batch.EmplaceBack();
+            entry.Object = handle;
+            if (object->GetComponent<CharacterControllerComponent>())
+                entry.Kind = ObjectKind::Character;
+            else if (object->GetComponent<DynamicBodyComponent>())
+                entry.Kind = ObjectKind::DynamicBody;
+            else if (object->GetComponent<StaticBodyComponent>())
+                entry.Kind = ObjectKind::StaticBody;
+            else
+                entry.Kind = ObjectKind::Other;
+        }
+        m_Pending.Clear();
+
+        // Stable order keeps the teardown deterministic
+        std::stable_sort(m_Batch.begin(), m_Batch.end(), [](Entry const& a, Entry const& b)
+        {
+            return a.Kind < b.Kind;
+        });
+
+        // Duplicates and children of already destroyed objects are skipped by the handle check
+        for (Entry const& entry : m_Batch)
+        {
+            if (GameObject* object = world->GetObject(entry.Object))
+                world->DestroyObject(object);
+        }
+    }
+}
+
+HK_NAMESPACE_END
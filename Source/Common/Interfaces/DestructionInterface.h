@@ -0,0 +1,89 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/World/World.h>
+
+#include <functional>
+
+HK_NAMESPACE_BEGIN
+
+// Collects destroy requests and tears the objects down as one batch at the end of the frame.
+// Gameplay callbacks (contacts, timers, parallel ticks) queue objects here instead of destroying them
+// in the middle of a physics or tick callback.
+class DestructionInterface : public WorldInterface
+{
+public:
+    using Callback = std::function<void()>;
+
+                        DestructionInterface();
+
+    // Queues the object and its children. Requesting the same object several times is fine.
+    void                Destroy(GameObjectHandle object);
+
+    // Calls the callback once the objects queued so far are destroyed, e.g. to release the resources they use
+    void                OnDestroyed(Callback callback);
+
+    // Destroys all queued objects now
+    void                Flush();
+
+    int                 GetPendingCount() const { return m_Pending.Size(); }
+
+protected:
+    void                Initialize() override;
+    void                Deinitialize() override;
+
+private:
+    // Objects of the same kind are destroyed together, bodies are grouped by broadphase layer
+    enum class ObjectKind : uint8_t
+    {
+        Character,
+        DynamicBody,
+        StaticBody,
+        Other
+    };
+
+    struct Entry
+    {
+        ObjectKind      Kind;
+        GameObjectHandle Object;
+    };
+
+    void                LateUpdate();
+
+    void                DestroyPending();
+
+    Vector<GameObjectHandle> m_Pending;
+    Vector<Entry>       m_Batch;
+    Vector<Callback>    m_Callbacks;
+};
+
+HK_NAMESPACE_END
@@ -0,0 +1,181 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "ExplosionInterface.h"
+#include "../TraceProfiler.h"
+#include "../TickStats.h"
+#include "../Components/FirstPersonComponent.h"
+#include "../Components/ProjectileComponent.h"
+#include "../JobPool.h"
+
+#include <Hork/World/Modules/Physics/Components/CharacterControllerComponent.h>
+#include <Hork/World/Modules/Physics/Components/DynamicBodyComponent.h>
+
+HK_NAMESPACE_BEGIN
+
+ExplosionInterface::ExplosionInterface()
+{}
+
+void ExplosionInterface::Initialize()
+{
+    TickFunction f;
+    f.Desc.Name.FromString("Resolve Explosions");
+    f.Desc.AddPrerequisiteInterface<PhysicsInterface>();
+    f.Group = TickGroup::PhysicsUpdate;
+    f.OwnerTypeID = GetInterfaceTypeID() | (1 << 31);
+    f.Delegate.Bind(this, &ExplosionInterface::Update);
+    RegisterTickFunction(f);
+}
+
+void ExplosionInterface::Deinitialize()
+{
+    m_Explosions.Clear();
+    m_Overlaps.Clear();
+    m_Targets.Clear();
+}
+
+void ExplosionInterface::Explode(Float3 const& center, float radius, float impulse, PlayerTeam team, GameObjectHandle ignore)
+{
+    m_Explosions.Add({center, radius, impulse, team, ignore});
+}
+
+void ExplosionInterface::Update()
+{
+    HK_TRACE_ZONE("PhysicsUpdate/Explosions");
+    HK_TICK_COST("ExplosionInterface", "PhysicsUpdate");
+
+    if (m_Explosions.IsEmpty())
+        return;
+
+    auto& physics = GetWorld()->GetInterface<PhysicsInterface>();
+    auto& jobs = JobPool::sGet();
+
+    // Broadphase overlaps, one per explosion
+    m_Overlaps.Resize(m_Explosions.Size());
+    jobs.ParallelFor(m_Explosions.Size(), 4, [this, &physics](int first, int last)
+    {
+        ShapeOverlapFilter filter;
+        filter.BroadphaseLayers.AddLayer(BroadphaseLayer::Dynamic);
+        filter.BroadphaseLayers.AddLayer(BroadphaseLayer::Character);
+
+        for (int i = first; i < last; ++i)
+        {
+            m_Overlaps[i].Clear();
+            physics.OverlapSphere(m_Explosions[i].Center, m_Explosions[i].Radius, m_Overlaps[i], filter);
+        }
+    });
+
+    // Collect affected objects
+    m_Targets.Clear();
+    for (int i = 0; i < m_Explosions.Size(); ++i)
+    {
+        Explosion const& explosion = m_Explosions[i];
+
+        for (PhysBodyID bodyID : m_Overlaps[i])
+        {
+            Target target;
+            target.ExplosionIndex = i;
+            target.Pawn = nullptr;
+            target.Body = nullptr;
+            target.IsVisible = false;
+
+            if (auto character = physics.TryGetComponent<CharacterControllerComponent>(bodyID))
+            {
+                GameObject* owner = character->GetOwner();
+                if (owner->GetHandle() == explosion.Ignore)
+                    continue;
+
+                target.Pawn = owner->GetComponent<FirstPersonComponent>();
+                if (!target.Pawn || target.Pawn->Team == explosion.Team)
+                    continue;
+
+                // Aim at the body center rather than the feet
+                target.Position = owner->GetWorldPosition() + Float3(0, 1, 0);
+            }
+            else if (auto body = physics.TryGetComponent<DynamicBodyComponent>(bodyID))
+            {
+                GameObject* owner = body->GetOwner();
+                if (owner->GetHandle() == explosion.Ignore || body->IsKinematic() || owner->GetComponent<ProjectileComponent>())
+                    continue;
+
+                target.Body = body;
+                target.Position = owner->GetWorldPosition();
+            }
+            else
+                continue;
+
+            m_Targets.Add(target);
+        }
+    }
+
+    // Line of sight against static geometry, all explosions in one batch
+    jobs.ParallelFor(m_Targets.Size(), 16, [this, &physics](int first, int last)
+    {
+        RayCastFilter filter;
+        filter.BroadphaseLayers.AddLayer(BroadphaseLayer::Static);
+
+        for (int i = first; i < last; ++i)
+        {
+            Target& target = m_Targets[i];
+            Float3 const& center = m_Explosions[target.ExplosionIndex].Center;
+
+            RayCastResult result;
+            target.IsVisible = !physics.CastRayClosest(center, target.Position - center, result, filter);
+        }
+    });
+
+    for (Target const& target : m_Targets)
+    {
+        if (!target.IsVisible)
+            continue;
+
+        Explosion const& explosion = m_Explosions[target.ExplosionIndex];
+
+        Float3 dir = target.Position - explosion.Center;
+        float dist = dir.Length();
+        if (dist > 0.0001f)
+            dir /= dist;
+        else
+            dir = Float3(0, 1, 0);
+
+        float falloff = Math::Max(1.0f - dist / explosion.Radius, 0.0f);
+        Float3 impulse = dir * (explosion.Impulse * falloff);
+
+        if (target.Pawn)
+            target.Pawn->ApplyDamage(impulse);
+        else
+            target.Body->AddImpulse(impulse);
+    }
+
+    m_Explosions.Clear();
+    m_Targets.Clear();
+}
+
+HK_NAMESPACE_END
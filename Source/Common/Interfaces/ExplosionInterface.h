@@ -0,0 +1,85 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/World/World.h>
+#include <Hork/World/Modules/Physics/PhysicsInterface.h>
+#include "../Components/PlayerTeam.h"
+
+HK_NAMESPACE_BEGIN
+
+class FirstPersonComponent;
+class DynamicBodyComponent;
+
+// Radius damage. Explosions requested during a tick are resolved together after the physics step:
+// one broadphase sphere overlap per explosion, then a single batch of line-of-sight rays against
+// static geometry for all candidates. Both batches run on the JobPool workers.
+class ExplosionInterface : public WorldInterface
+{
+public:
+                        ExplosionInterface();
+
+    // Pushes characters of other teams and dynamic bodies within the radius. The impulse falls off linearly
+    // with distance. The ignored object (e.g. a directly hit character) is not affected.
+    void                Explode(Float3 const& center, float radius, float impulse, PlayerTeam team, GameObjectHandle ignore = {});
+
+protected:
+    void                Initialize() override;
+    void                Deinitialize() override;
+
+private:
+    struct Explosion
+    {
+        Float3          Center;
+        float           Radius;
+        float           Impulse;
+        PlayerTeam      Team;
+        GameObjectHandle Ignore;
+    };
+
+    // Valid only during Update(), the world is not modified while the rays are cast
+    struct Target
+    {
+        int             ExplosionIndex;
+        Float3          Position;
+        FirstPersonComponent* Pawn;
+        DynamicBodyComponent* Body;
+        bool            IsVisible;
+    };
+
+    void                Update();
+
+    Vector<Explosion>   m_Explosions;
+    Vector<Vector<PhysBodyID>> m_Overlaps;
+    Vector<Target>      m_Targets;
+};
+
+HK_NAMESPACE_END
@@ -0,0 +1,129 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "HitscanInterface.h"
+#include "../TraceProfiler.h"
+#include "../TickStats.h"
+#include "../Components/FirstPersonComponent.h"
+#include "../JobPool.h"
+
+#include <Hork/World/Modules/Physics/Components/CharacterControllerComponent.h>
+#include <Hork/World/Modules/Physics/Components/DynamicBodyComponent.h>
+
+HK_NAMESPACE_BEGIN
+
+HitscanInterface::HitscanInterface()
+{}
+
+void HitscanInterface::Initialize()
+{
+    TickFunction f;
+    f.Desc.Name.FromString("Resolve Hitscan");
+    f.Desc.AddPrerequisiteInterface<PhysicsInterface>();
+    f.Group = TickGroup::PhysicsUpdate;
+    f.OwnerTypeID = GetInterfaceTypeID() | (1 << 31);
+    f.Delegate.Bind(this, &HitscanInterface::Update);
+    RegisterTickFunction(f);
+}
+
+void HitscanInterface::Deinitialize()
+{
+    m_Shots.Clear();
+    m_Hits.Clear();
+}
+
+void HitscanInterface::Fire(Float3 const& start, Float3 const& direction, float range, float impulse, PlayerTeam team)
+{
+    m_Shots.Add({start, direction, range, impulse, team});
+}
+
+void HitscanInterface::Update()
+{
+    HK_TRACE_ZONE("PhysicsUpdate/Hitscan");
+    HK_TICK_COST("HitscanInterface", "PhysicsUpdate");
+
+    if (m_Shots.IsEmpty())
+        return;
+
+    auto& physics = GetWorld()->GetInterface<PhysicsInterface>();
+
+    m_Hits.Resize(m_Shots.Size());
+
+    // Scene queries are read-only and safe to run concurrently between physics steps
+    JobPool::sGet().ParallelFor(m_Shots.Size(), BatchSize, [this, &physics](int first, int last)
+    {
+        RayCastFilter filter;
+        filter.BroadphaseLayers.AddLayer(BroadphaseLayer::Static);
+        filter.BroadphaseLayers.AddLayer(BroadphaseLayer::Dynamic);
+        filter.BroadphaseLayers.AddLayer(BroadphaseLayer::Character);
+
+        for (int i = first; i < last; ++i)
+        {
+            Shot const& shot = m_Shots[i];
+            Hit& hit = m_Hits[i];
+
+            RayCastResult result;
+            hit.IsHit = physics.CastRayClosest(shot.Start, shot.Direction * shot.Range, result, filter);
+            if (hit.IsHit)
+            {
+                hit.BodyID = result.BodyID;
+                hit.Distance = result.Fraction * shot.Range;
+            }
+        }
+    });
+
+    // Apply the results on the calling thread in the order the shots were fired
+    for (int i = 0; i < m_Shots.Size(); ++i)
+    {
+        Shot const& shot = m_Shots[i];
+        Hit const& hit = m_Hits[i];
+
+        if (!hit.IsHit)
+            continue;
+
+        if (auto character = physics.TryGetComponent<CharacterControllerComponent>(hit.BodyID))
+        {
+            if (auto pawn = character->GetOwner()->GetComponent<FirstPersonComponent>())
+            {
+                if (pawn->Team != shot.Team)
+                    pawn->ApplyDamage(shot.Direction * shot.Impulse);
+            }
+        }
+        else if (auto body = physics.TryGetComponent<DynamicBodyComponent>(hit.BodyID))
+        {
+            if (!body->IsKinematic())
+                body->AddImpulse(shot.Direction * shot.Impulse);
+        }
+    }
+
+    m_Shots.Clear();
+}
+
+HK_NAMESPACE_END
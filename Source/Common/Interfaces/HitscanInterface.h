@@ -0,0 +1,81 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/World/World.h>
+#include <Hork/World/Modules/Physics/PhysicsInterface.h>
+#include "../Components/PlayerTeam.h"
+
+HK_NAMESPACE_BEGIN
+
+// Instant-hit weapon fire. Shots fired during a tick are queued and resolved together after the
+// physics step as one batch of ray casts, spread over the JobPool workers.
+class HitscanInterface : public WorldInterface
+{
+public:
+    // Shots per parallel batch
+    int                 BatchSize = 16;
+
+                        HitscanInterface();
+
+    // Direction must be normalized
+    void                Fire(Float3 const& start, Float3 const& direction, float range, float impulse, PlayerTeam team);
+
+    int                 GetPendingShotCount() const { return m_Shots.Size(); }
+
+protected:
+    void                Initialize() override;
+    void                Deinitialize() override;
+
+private:
+    struct Shot
+    {
+        Float3          Start;
+        Float3          Direction;
+        float           Range;
+        float           Impulse;
+        PlayerTeam      Team;
+    };
+
+    struct Hit
+    {
+        PhysBodyID      BodyID;
+        float           Distance;
+        bool            IsHit;
+    };
+
+    void                Update();
+
+    Vector<Shot>        m_Shots;
+    Vector<Hit>         m_Hits;
+};
+
+HK_NAMESPACE_END
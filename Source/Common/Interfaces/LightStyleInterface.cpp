@@ -0,0 +1,216 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "LightStyleInterface.h"
+#include "../TraceProfiler.h"
+#include "../TickStats.h"
+
+HK_NAMESPACE_BEGIN
+
+namespace
+{
+    const char* BuiltinStyles[LightStyleInterface::BuiltinStyleCount] =
+    {
+        "mmnmmommommnonmmonqnmmo",                      // Flicker1
+        "abcdefghijklmnopqrstuvwxyzyxwvutsrqponmlkjihgfedcba", // SlowStrongPulse
+        "mmmmmaaaaammmmmaaaaaabcdefgabcdefg",           // Candle
+        "mamamamamama",                                 // FastStrobe
+        "jklmnopqrstuvwxyzyxwvutsrqponmlkj",            // GentlePulse
+        "nmonqnmomnmomomno",                            // Flicker2
+        "mmmaaaabcdefgmmmmaaaammmaamm",                 // Candle2
+        "mmmaaammmaaammmabcdefaaaammmmabcdefmmmaaaa",   // Candle3
+        "aaaaaaaazzzzzzzz",                             // SlowStrobe
+        "mmamammmmammamamaaamammma",                    // FluorescentFlicker
+        "abcdefghijklmnopqrrqponmlkjihgfedcba"          // SlowPulse
+    };
+
+    HK_FORCEINLINE float SampleStyle(Vector<float> const& frames, float position)
+    {
+        int frameCount = frames.Size();
+
+        int keyframe = Math::Floor(position);
+        float lerp = position - keyframe;
+
+        // Keep the modulo positive for negative time offsets
+        keyframe %= frameCount;
+        if (keyframe < 0)
+            keyframe += frameCount;
+
+        int nextframe = keyframe + 1;
+        if (nextframe == frameCount)
+            nextframe = 0;
+
+        return Math::Lerp(frames[keyframe], frames[nextframe], lerp);
+    }
+}
+
+LightStyleInterface::LightStyleInterface()
+{}
+
+void LightStyleInterface::Initialize()
+{
+    for (const char* sequence : BuiltinStyles)
+        RegisterStyle(sequence);
+
+    TickFunction f;
+    f.Desc.Name.FromString("Update Light Styles");
+    f.Group = TickGroup::Update;
+    f.OwnerTypeID = GetInterfaceTypeID() | (1 << 31);
+    f.Delegate.Bind(this, &LightStyleInterface::Update);
+    RegisterTickFunction(f);
+}
+
+void LightStyleInterface::Deinitialize()
+{
+    m_Styles.Clear();
+    m_StyleValues.Clear();
+    m_Lights.Clear();
+    m_LightStyles.Clear();
+    m_TimeOffsets.Clear();
+    m_LastValues.Clear();
+    m_IndexToID.Clear();
+    m_IDToIndex.Clear();
+    m_FreeIDs.Clear();
+}
+
+int LightStyleInterface::RegisterStyle(StringView sequence)
+{
+    for (int style = 0; style < m_Styles.Size(); ++style)
+    {
+        if (m_Styles[style].Sequence == sequence)
+            return style;
+    }
+
+    Style& style = m_Styles.EmplaceBack();
+    style.Sequence = sequence;
+
+    if (sequence.IsEmpty())
+    {
+        // Constant normal brightness
+        style.Frames.Add(1.0f);
+    }
+    else
+    {
+        style.Frames.Reserve(sequence.Size());
+        for (int i = 0; i < sequence.Size(); ++i)
+            style.Frames.Add((Math::Clamp(sequence[i], 'a', 'z') - 'a') / 26.0f * 2);
+    }
+
+    m_StyleValues.Add(style.Frames[0]);
+
+    return m_Styles.Size() - 1;
+}
+
+LightAnimatorID LightStyleInterface::AddAnimator(Handle32<PunctualLightComponent> light, int style, float timeOffset)
+{
+    HK_ASSERT(style >= 0 && style < m_Styles.Size());
+
+    LightAnimatorID id;
+    if (!m_FreeIDs.IsEmpty())
+    {
+        id = m_FreeIDs.Last();
+        m_FreeIDs.RemoveLast();
+    }
+    else
+    {
+        id = m_IDToIndex.Size();
+        m_IDToIndex.Add(0);
+    }
+
+    m_IDToIndex[id] = m_Lights.Size();
+
+    m_Lights.Add(light);
+    m_LightStyles.Add(style);
+    m_TimeOffsets.Add(timeOffset);
+    m_LastValues.Add(-1);
+    m_IndexToID.Add(id);
+
+    return id;
+}
+
+void LightStyleInterface::RemoveAnimator(LightAnimatorID id)
+{
+    uint32_t index = m_IDToIndex[id];
+    uint32_t last = m_Lights.Size() - 1;
+
+    m_FreeIDs.Add(id);
+
+    // Move the last animator into the freed slot to keep the arrays dense
+    if (index != last)
+    {
+        m_Lights[index] = m_Lights[last];
+        m_LightStyles[index] = m_LightStyles[last];
+        m_TimeOffsets[index] = m_TimeOffsets[last];
+        m_LastValues[index] = m_LastValues[last];
+        m_IndexToID[index] = m_IndexToID[last];
+
+        m_IDToIndex[m_IndexToID[index]] = index;
+    }
+
+    m_Lights.RemoveLast();
+    m_LightStyles.RemoveLast();
+    m_TimeOffsets.RemoveLast();
+    m_LastValues.RemoveLast();
+    m_IndexToID.RemoveLast();
+}
+
+void LightStyleInterface::Update()
+{
+    HK_TRACE_ZONE("Update/LightStyles");
+    HK_TICK_COST("LightStyleInterface", "Update");
+
+    World* world = GetWorld();
+
+    float position = world->GetTick().FrameTime * Speed;
+
+    // Evaluate every style once
+    for (int style = 0; style < m_Styles.Size(); ++style)
+        m_StyleValues[style] = SampleStyle(m_Styles[style].Frames, position);
+
+    // Update the lights whose quantized brightness has changed
+    for (uint32_t i = 0, count = m_Lights.Size(); i < count; ++i)
+    {
+        float brightness = m_TimeOffsets[i] == 0.0f
+            ? m_StyleValues[m_LightStyles[i]]
+            : SampleStyle(m_Styles[m_LightStyles[i]].Frames, position + m_TimeOffsets[i]);
+
+        int value = int(brightness * Quantization + 0.5f);
+        if (value == m_LastValues[i])
+            continue;
+
+        if (auto light = world->GetComponent(m_Lights[i]))
+        {
+            light->SetColor(Float3(value / Quantization));
+            m_LastValues[i] = value;
+        }
+    }
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,97 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/World/World.h>
+#include <Hork/World/Modules/Render/Components/PunctualLightComponent.h>
+
+HK_NAMESPACE_BEGIN
+
+using LightAnimatorID = uint32_t;
+
+// Quake styled light animation. Every style is evaluated once per frame into a shared table, then all
+// animated lights read it in one pass. Lights are only touched when their quantized brightness changes.
+class LightStyleInterface : public WorldInterface
+{
+public:
+    // Built-in styles, matching LightAnimator::AnimationType
+    static constexpr int BuiltinStyleCount = 11;
+
+    // Sequence frames per second
+    float               Speed = 10;
+
+    // Brightness steps per unit; brightness changes smaller than a step are not sent to the light
+    float               Quantization = 128;
+
+                        LightStyleInterface();
+
+    // Returns the style for a sequence of 'a'..'z' brightness frames ('a' = no light, 'z' = double bright).
+    // Identical sequences share a style.
+    int                 RegisterStyle(StringView sequence);
+
+    // Time offset shifts the animation of a single light; lights without an offset read the shared value
+    LightAnimatorID     AddAnimator(Handle32<PunctualLightComponent> light, int style, float timeOffset);
+    void                RemoveAnimator(LightAnimatorID id);
+
+    float               GetStyleBrightness(int style) const { return m_StyleValues[style]; }
+
+    int                 GetStyleCount() const { return m_Styles.Size(); }
+    int                 GetAnimatorCount() const { return m_Lights.Size(); }
+
+protected:
+    void                Initialize() override;
+    void                Deinitialize() override;
+
+private:
+    struct Style
+    {
+        String          Sequence;
+        Vector<float>   Frames;
+    };
+
+    void                Update();
+
+    Vector<Style>       m_Styles;
+    Vector<float>       m_StyleValues;
+
+    // Dense arrays, indexed by animator index
+    Vector<Handle32<PunctualLightComponent>> m_Lights;
+    Vector<int>         m_LightStyles;
+    Vector<float>       m_TimeOffsets;
+    Vector<int>         m_LastValues;
+    Vector<LightAnimatorID> m_IndexToID;
+
+    // Sparse mapping, indexed by animator ID
+    Vector<uint32_t>    m_IDToIndex;
+    Vector<LightAnimatorID> m_FreeIDs;
+};
+
+HK_NAMESPACE_END
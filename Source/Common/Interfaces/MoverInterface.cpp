@@ -0,0 +1,355 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "MoverInterface.h"
+#include "../TraceProfiler.h"
+#include "../TickStats.h"
+#include "TimerInterface.h"
+
+HK_NAMESPACE_BEGIN
+
+MoverInterface::MoverInterface()
+{}
+
+void MoverInterface::Initialize()
+{
+    TickFunction f;
+    f.Desc.Name.FromString("Update Movers");
+    f.Group = TickGroup::FixedUpdate;
+    f.OwnerTypeID = GetInterfaceTypeID() | (1 << 31);
+    f.Delegate.Bind(this, &MoverInterface::FixedUpdate);
+    RegisterTickFunction(f);
+}
+
+void MoverInterface::Deinitialize()
+{
+    m_Objects.Clear();
+    m_StartPositions.Clear();
+    m_Directions.Clear();
+    m_Distances.Clear();
+    m_MaxDistances.Clear();
+    m_OpenSpeeds.Clear();
+    m_CloseSpeeds.Clear();
+    m_WaitTimes.Clear();
+    m_WaitTimers.Clear();
+    m_States.Clear();
+    m_Hold.Clear();
+    m_Triggered.Clear();
+    m_IndexToID.Clear();
+    m_RangeEnd[Range_Opening] = 0;
+    m_RangeEnd[Range_Closing] = 0;
+    m_SlotToIndex.Clear();
+    m_SlotGenerations.Clear();
+    m_FreeSlots.Clear();
+    m_Finished.Clear();
+}
+
+MoverID MoverInterface::AddMover(GameObject* object, MoverDesc const& desc)
+{
+    uint32_t slot;
+    if (!m_FreeSlots.IsEmpty())
+    {
+        slot = m_FreeSlots.Last();
+        m_FreeSlots.RemoveLast();
+    }
+    else
+    {
+        slot = m_SlotToIndex.Size();
+        m_SlotToIndex.Add(0);
+        m_SlotGenerations.Add(1);
+    }
+
+    MoverID id = (MoverID(m_SlotGenerations[slot]) << 32) | slot;
+
+    // New movers are closed, so they go to the end of the sleeping range
+    m_SlotToIndex[slot] = m_Objects.Size();
+
+    m_Objects.Add(object->GetHandle());
+    m_StartPositions.Add(object->GetPosition());
+    m_Directions.Add(desc.Direction);
+    m_Distances.Add(0);
+    m_MaxDistances.Add(desc.Distance);
+    m_OpenSpeeds.Add(desc.OpenSpeed);
+    m_CloseSpeeds.Add(desc.CloseSpeed);
+    m_WaitTimes.Add(desc.WaitTime);
+    m_WaitTimers.Add(0);
+    m_States.Add(MoverState::Closed);
+    m_Hold.Add(0);
+    m_Triggered.Add(0);
+    m_IndexToID.Add(id);
+
+    return id;
+}
+
+bool MoverInterface::FindIndex(MoverID id, uint32_t& index) const
+{
+    uint32_t slot = uint32_t(id & 0xffffffff);
+    uint32_t generation = uint32_t(id >> 32);
+
+    if (slot >= uint32_t(m_SlotToIndex.Size()) || m_SlotGenerations[slot] != generation)
+        return false;
+
+    index = m_SlotToIndex[slot];
+    return true;
+}
+
+void MoverInterface::RemoveMover(MoverID id)
+{
+    uint32_t index;
+    if (FindIndex(id, index))
+        RemoveAt(index);
+}
+
+void MoverInterface::RemoveAt(uint32_t index)
+{
+    GetWorld()->GetInterface<TimerInterface>().Cancel(m_WaitTimers[index]);
+
+    index = MoveToRange(index, Range_Sleeping);
+
+    // Stale IDs of the slot no longer match
+    uint32_t slot = uint32_t(m_IndexToID[index] & 0xffffffff);
+    m_SlotGenerations[slot]++;
+    m_FreeSlots.Add(slot);
+
+    // Move the last mover into the freed slot to keep the arrays dense
+    uint32_t last = m_Objects.Size() - 1;
+    if (index != last)
+        Swap(index, last);
+
+    m_Objects.RemoveLast();
+    m_StartPositions.RemoveLast();
+    m_Directions.RemoveLast();
+    m_Distances.RemoveLast();
+    m_MaxDistances.RemoveLast();
+    m_OpenSpeeds.RemoveLast();
+    m_CloseSpeeds.RemoveLast();
+    m_WaitTimes.RemoveLast();
+    m_WaitTimers.RemoveLast();
+    m_States.RemoveLast();
+    m_Hold.RemoveLast();
+    m_Triggered.RemoveLast();
+    m_IndexToID.RemoveLast();
+}
+
+void MoverInterface::Swap(uint32_t index1, uint32_t index2)
+{
+    if (index1 == index2)
+        return;
+
+    std::swap(m_Objects[index1], m_Objects[index2]);
+    std::swap(m_StartPositions[index1], m_StartPositions[index2]);
+    std::swap(m_Directions[index1], m_Directions[index2]);
+    std::swap(m_Distances[index1], m_Distances[index2]);
+    std::swap(m_MaxDistances[index1], m_MaxDistances[index2]);
+    std::swap(m_OpenSpeeds[index1], m_OpenSpeeds[index2]);
+    std::swap(m_CloseSpeeds[index1], m_CloseSpeeds[index2]);
+    std::swap(m_WaitTimes[index1], m_WaitTimes[index2]);
+    std::swap(m_WaitTimers[index1], m_WaitTimers[index2]);
+    std::swap(m_States[index1], m_States[index2]);
+    std::swap(m_Hold[index1], m_Hold[index2]);
+    std::swap(m_Triggered[index1], m_Triggered[index2]);
+    std::swap(m_IndexToID[index1], m_IndexToID[index2]);
+
+    m_SlotToIndex[uint32_t(m_IndexToID[index1] & 0xffffffff)] = index1;
+    m_SlotToIndex[uint32_t(m_IndexToID[index2] & 0xffffffff)] = index2;
+}
+
+uint32_t MoverInterface::MoveToRange(uint32_t index, Range range)
+{
+    int current = index < m_RangeEnd[Range_Opening] ? Range_Opening : (index < m_RangeEnd[Range_Closing] ? Range_Closing : Range_Sleeping);
+
+    // Cross one range boundary at a time, swapping with the mover next to it
+    while (current < range)
+    {
+        uint32_t& end = m_RangeEnd[current++];
+        Swap(index, end - 1);
+        index = --end;
+    }
+    while (current > range)
+    {
+        uint32_t& end = m_RangeEnd[--current];
+        Swap(index, end);
+        index = end++;
+    }
+    return index;
+}
+
+void MoverInterface::SetState(uint32_t index, MoverState state)
+{
+    m_States[index] = state;
+
+    switch (state)
+    {
+        case MoverState::Opening:
+            MoveToRange(index, Range_Opening);
+            break;
+        case MoverState::Closing:
+            MoveToRange(index, Range_Closing);
+            break;
+        default:
+            MoveToRange(index, Range_Sleeping);
+            break;
+    }
+}
+
+void MoverInterface::SetHold(MoverID id, bool hold)
+{
+    uint32_t index;
+    if (!FindIndex(id, index))
+        return;
+
+    m_Hold[index] = hold;
+
+    if (hold)
+    {
+        // An opened mover stays open while held
+        GetWorld()->GetInterface<TimerInterface>().Cancel(m_WaitTimers[index]);
+        m_WaitTimers[index] = 0;
+
+        // A closing mover opens again when it is closed
+        if (m_States[index] == MoverState::Closed)
+            SetState(index, MoverState::Opening);
+    }
+    else if (m_States[index] == MoverState::Opened)
+        StartWaitTimer(index);
+}
+
+void MoverInterface::StartWaitTimer(uint32_t index)
+{
+    auto& timers = GetWorld()->GetInterface<TimerInterface>();
+
+    MoverID id = m_IndexToID[index];
+
+    timers.Cancel(m_WaitTimers[index]);
+    m_WaitTimers[index] = timers.Schedule(m_WaitTimes[index], [this, id]() { OnWaitFinished(id); });
+}
+
+void MoverInterface::OnWaitFinished(MoverID id)
+{
+    uint32_t index;
+    if (!FindIndex(id, index))
+        return;
+
+    m_WaitTimers[index] = 0;
+
+    if (m_States[index] == MoverState::Opened)
+        SetState(index, MoverState::Closing);
+}
+
+void MoverInterface::Trigger(MoverID id)
+{
+    uint32_t index;
+    if (!FindIndex(id, index))
+        return;
+
+    if (m_States[index] == MoverState::Closed)
+        SetState(index, MoverState::Opening);
+    else
+        m_Triggered[index] = 1;
+}
+
+MoverState MoverInterface::GetState(MoverID id) const
+{
+    uint32_t index;
+    if (!FindIndex(id, index))
+        return MoverState::Closed;
+
+    return m_States[index];
+}
+
+void MoverInterface::OnFinished(MoverID id)
+{
+    uint32_t index;
+    FindIndex(id, index);
+
+    if (m_States[index] == MoverState::Opening)
+    {
+        SetState(index, MoverState::Opened);
+
+        // Held movers start waiting when released
+        if (!m_Hold[index])
+            StartWaitTimer(index);
+    }
+    else if (m_Hold[index] || m_Triggered[index])
+    {
+        m_Triggered[index] = 0;
+        SetState(index, MoverState::Opening);
+    }
+    else
+        SetState(index, MoverState::Closed);
+}
+
+void MoverInterface::FixedUpdate()
+{
+    HK_TRACE_ZONE("FixedUpdate/Movers");
+    HK_TICK_COST("MoverInterface", "FixedUpdate");
+
+    float timeStep = GetWorld()->GetTick().FixedTimeStep;
+
+    uint32_t openingEnd = m_RangeEnd[Range_Opening];
+    uint32_t closingEnd = m_RangeEnd[Range_Closing];
+
+    float* distances = m_Distances.ToPtr();
+    float const* maxDistances = m_MaxDistances.ToPtr();
+    float const* openSpeeds = m_OpenSpeeds.ToPtr();
+    float const* closeSpeeds = m_CloseSpeeds.ToPtr();
+
+    for (uint32_t i = 0; i < openingEnd; ++i)
+        distances[i] = Math::Min(distances[i] + openSpeeds[i] * timeStep, maxDistances[i]);
+
+    for (uint32_t i = openingEnd; i < closingEnd; ++i)
+        distances[i] = Math::Max(distances[i] - closeSpeeds[i] * timeStep, 0.0f);
+
+    // Write transforms of the movers that moved
+    World* world = GetWorld();
+    for (uint32_t i = 0; i < closingEnd; ++i)
+    {
+        if (GameObject* object = world->GetObject(m_Objects[i]))
+            object->SetPosition(m_StartPositions[i] + m_Directions[i] * distances[i]);
+    }
+
+    // State changes move movers between the ranges, so collect them first
+    m_Finished.Clear();
+    for (uint32_t i = 0; i < openingEnd; ++i)
+    {
+        if (distances[i] >= maxDistances[i])
+            m_Finished.Add(m_IndexToID[i]);
+    }
+    for (uint32_t i = openingEnd; i < closingEnd; ++i)
+    {
+        if (distances[i] <= 0)
+            m_Finished.Add(m_IndexToID[i]);
+    }
+
+    for (MoverID id : m_Finished)
+        OnFinished(id);
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,139 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "TimerInterface.h"
+
+HK_NAMESPACE_BEGIN
+
+// Generation in the high bits, slot in the low bits. Zero is never a valid mover.
+using MoverID = uint64_t;
+
+struct MoverDesc
+{
+    // Unit direction of movement in local space
+    Float3          Direction = Float3(0, 1, 0);
+
+    // Travel distance from the start position
+    float           Distance = 1;
+
+    float           OpenSpeed = 1;
+    float           CloseSpeed = 1;
+
+    // How long the mover stays open before returning
+    float           WaitTime = 2;
+};
+
+enum class MoverState : uint8_t
+{
+    Closed,
+    Opening,
+    Opened,
+    Closing
+};
+
+// Advances all linear movers (doors, elevators, platforms) of the world in one pass per fixed step.
+// The state is kept in parallel arrays split into ranges by state: opening, closing and sleeping movers.
+// Each moving range is advanced by its own branch-free loop. Closed and opened movers sleep and cost nothing
+// until SetHold(), Trigger() or the wait timer wakes them.
+class MoverInterface : public WorldInterface
+{
+public:
+                        MoverInterface();
+
+    // The current local position of the object is the closed position
+    MoverID             AddMover(GameObject* object, MoverDesc const& desc);
+
+    // Safe to call with removed movers and after the interface is deinitialized
+    void                RemoveMover(MoverID id);
+
+    // While held, a closed mover opens and an opened mover doesn't return
+    void                SetHold(MoverID id, bool hold);
+
+    // Opens the mover once. A trigger received while the mover is busy is kept until it is closed.
+    void                Trigger(MoverID id);
+
+    // Unknown movers are reported as closed
+    MoverState          GetState(MoverID id) const;
+
+    int                 GetMoverCount() const { return m_Objects.Size(); }
+    int                 GetAwakeMoverCount() const { return m_RangeEnd[Range_Closing]; }
+
+protected:
+    void                Initialize() override;
+    void                Deinitialize() override;
+
+private:
+    enum Range
+    {
+        Range_Opening,
+        Range_Closing,
+        Range_Sleeping
+    };
+
+    bool                FindIndex(MoverID id, uint32_t& index) const;
+    void                FixedUpdate();
+    void                RemoveAt(uint32_t index);
+    uint32_t            MoveToRange(uint32_t index, Range range);
+    void                SetState(uint32_t index, MoverState state);
+    void                Swap(uint32_t index1, uint32_t index2);
+    void                StartWaitTimer(uint32_t index);
+    void                OnFinished(MoverID id);
+    void                OnWaitFinished(MoverID id);
+
+    // Dense arrays, indexed by mover index. Opening movers come first, then closing, then sleeping ones.
+    Vector<GameObjectHandle> m_Objects;
+    Vector<Float3>      m_StartPositions;
+    Vector<Float3>      m_Directions;
+    Vector<float>       m_Distances;
+    Vector<float>       m_MaxDistances;
+    Vector<float>       m_OpenSpeeds;
+    Vector<float>       m_CloseSpeeds;
+    Vector<float>       m_WaitTimes;
+    Vector<TimerID>     m_WaitTimers;
+    Vector<MoverState>  m_States;
+    Vector<uint8_t>     m_Hold;
+    Vector<uint8_t>     m_Triggered;
+    Vector<MoverID>     m_IndexToID;
+
+    // End of the opening and closing ranges. The sleeping range ends at the mover count.
+    uint32_t            m_RangeEnd[2] = {};
+
+    // Sparse mapping, indexed by slot
+    Vector<uint32_t>    m_SlotToIndex;
+    Vector<uint32_t>    m_SlotGenerations;
+    Vector<uint32_t>    m_FreeSlots;
+
+    // Movers that reached the end of their movement during the current step
+    Vector<MoverID>     m_Finished;
+};
+
+HK_NAMESPACE_END
@@ -0,0 +1,160 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "ParallelTickInterface.h"
+#include "PlayerInputInterface.h"
+#include "../TraceProfiler.h"
+#include "../TickStats.h"
+#include "../JobPool.h"
+
+#include <atomic>
+
+HK_NAMESPACE_BEGIN
+
+uint32_t ParallelTickInterface::GroupBase::AllocID()
+{
+    uint32_t id;
+    if (!m_FreeIDs.IsEmpty())
+    {
+        id = m_FreeIDs.Last();
+        m_FreeIDs.RemoveLast();
+    }
+    else
+    {
+        id = m_IDToIndex.Size();
+        m_IDToIndex.Add(0);
+    }
+
+    m_IDToIndex[id] = m_IndexToID.Size();
+    m_IndexToID.Add(id);
+    return id;
+}
+
+void ParallelTickInterface::GroupBase::FreeID(uint32_t id)
+{
+    uint32_t index = m_IDToIndex[id];
+    uint32_t lastIndex = m_IndexToID.Size() - 1;
+
+    RemoveAt(index);
+
+    m_IndexToID[index] = m_IndexToID[lastIndex];
+    m_IDToIndex[m_IndexToID[index]] = index;
+    m_IndexToID.RemoveLast();
+
+    m_FreeIDs.Add(id);
+}
+
+uint32_t ParallelTickInterface::sNextGroupIndex()
+{
+    static std::atomic<uint32_t> counter{0};
+    return counter++;
+}
+
+ParallelTickInterface::ParallelTickInterface()
+{}
+
+void ParallelTickInterface::Initialize()
+{
+    TickFunction f;
+    f.Desc.Name.FromString("Parallel Fixed Update");
+    f.Desc.AddPrerequisiteInterface<PlayerInputInterface>();
+    f.Group = TickGroup::FixedUpdate;
+    f.OwnerTypeID = GetInterfaceTypeID() | (1 << 31);
+    f.Delegate.Bind(this, &ParallelTickInterface::FixedUpdate);
+    RegisterTickFunction(f);
+}
+
+void ParallelTickInterface::Deinitialize()
+{
+    m_Groups.Clear();
+    m_Buffers.Clear();
+}
+
+void ParallelTickInterface::Remove(ParallelTickID id)
+{
+    m_Groups[id >> GroupShift]->FreeID(id & ((1u << GroupShift) - 1));
+}
+
+int ParallelTickInterface::GetComponentCount() const
+{
+    int count = 0;
+    for (auto& group : m_Groups)
+        if (group)
+            count += group->GetSize();
+    return count;
+}
+
+void ParallelTickInterface::FixedUpdate()
+{
+    HK_TRACE_ZONE("FixedUpdate/ParallelTick");
+    HK_TICK_COST("ParallelTickInterface", "FixedUpdate");
+
+    World* world = GetWorld();
+    JobPool& jobs = JobPool::sGet();
+
+    int batchSize = Math::Max(BatchSize, 1);
+
+    // Command buffers are numbered by group and batch, so the order of execution is fixed
+    int bufferOffset = 0;
+    for (auto& group : m_Groups)
+    {
+        if (!group)
+            continue;
+
+        int count = group->Gather(world);
+        if (!count)
+            continue;
+
+        int batchCount = (count + batchSize - 1) / batchSize;
+        if (m_Buffers.Size() < bufferOffset + batchCount)
+            m_Buffers.Resize(bufferOffset + batchCount);
+
+        GroupBase* groupPtr = group.RawPtr();
+        jobs.ParallelFor(count, batchSize, [this, groupPtr, batchSize, bufferOffset](int first, int last)
+        {
+            for (int batchFirst = first; batchFirst < last; batchFirst += batchSize)
+            {
+                int batchLast = Math::Min(batchFirst + batchSize, last);
+
+                uint64_t start = TickStats::sReadCycles();
+                groupPtr->Run(batchFirst, batchLast, m_Buffers[bufferOffset + batchFirst / batchSize]);
+                TickStats::sAdd(*groupPtr->Stats, batchLast - batchFirst, TickStats::sReadCycles() - start);
+            }
+        });
+
+        bufferOffset += batchCount;
+    }
+
+    // Sync point
+    for (int i = 0; i < bufferOffset; ++i)
+        m_Buffers[i].Execute(world);
+}
+
+HK_NAMESPACE_END
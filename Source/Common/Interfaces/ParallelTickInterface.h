@@ -0,0 +1,170 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/World/World.h>
+
+#include "../CommandBuffer.h"
+#include "../TickStats.h"
+
+HK_NAMESPACE_BEGIN
+
+using ParallelTickID = uint32_t;
+
+// Opt-in parallel FixedUpdate. A registered component implements
+//
+//     void ParallelFixedUpdate(CommandBuffer& commands);
+//
+// and runs on the job pool together with other components. It may read the world but must not modify it:
+// all mutations are recorded into the command buffer and applied on the main thread once every component
+// is done. Command buffers belong to fixed batches and are executed in batch order, so the result doesn't
+// depend on which thread ran which batch.
+class ParallelTickInterface : public WorldInterface
+{
+public:
+    // Components per batch, each batch records into its own command buffer
+    int                 BatchSize = 256;
+
+                        ParallelTickInterface();
+
+    template <typename T>
+    ParallelTickID      Add(T* component);
+
+    void                Remove(ParallelTickID id);
+
+    int                 GetComponentCount() const;
+
+protected:
+    void                Initialize() override;
+    void                Deinitialize() override;
+
+private:
+    // Components of one type
+    class GroupBase
+    {
+    public:
+        virtual         ~GroupBase() = default;
+
+        // Resolves live components on the main thread. Returns the number of components to tick.
+        virtual int     Gather(World* world) = 0;
+
+        // Ticks gathered components in range [first, last)
+        virtual void    Run(int first, int last, CommandBuffer& commands) = 0;
+
+        uint32_t        AllocID();
+        void            FreeID(uint32_t id);
+
+        int             GetSize() const { return m_IndexToID.Size(); }
+
+        TickStats::Entry* Stats{};
+
+    protected:
+        // Removes the element at index by moving the last element in its place
+        virtual void    RemoveAt(int index) = 0;
+
+    private:
+        Vector<uint32_t> m_IndexToID;
+        Vector<uint32_t> m_IDToIndex;
+        Vector<uint32_t> m_FreeIDs;
+    };
+
+    template <typename T>
+    class Group final : public GroupBase
+    {
+    public:
+        Vector<Handle32<T>> Components;
+
+        int Gather(World* world) override
+        {
+            m_Active.Clear();
+            for (Handle32<T> handle : Components)
+                if (T* component = world->GetComponent(handle))
+                    m_Active.Add(component);
+            return m_Active.Size();
+        }
+
+        void Run(int first, int last, CommandBuffer& commands) override
+        {
+            for (int i = first; i < last; ++i)
+                m_Active[i]->ParallelFixedUpdate(commands);
+        }
+
+    protected:
+        void RemoveAt(int index) override
+        {
+            Components[index] = Components.Last();
+            Components.RemoveLast();
+        }
+
+    private:
+        Vector<T*>      m_Active;
+    };
+
+    static uint32_t     sNextGroupIndex();
+
+    template <typename T>
+    static uint32_t     sGetGroupIndex()
+    {
+        static const uint32_t index = sNextGroupIndex();
+        return index;
+    }
+
+    // ID layout: group index in the high 8 bits, ID within the group in the low 24 bits
+    static constexpr int GroupShift = 24;
+
+    void                FixedUpdate();
+
+    Vector<UniqueRef<GroupBase>> m_Groups;
+    Vector<CommandBuffer> m_Buffers;
+};
+
+template <typename T>
+HK_INLINE ParallelTickID ParallelTickInterface::Add(T* component)
+{
+    uint32_t groupIndex = sGetGroupIndex<T>();
+    if (groupIndex >= m_Groups.Size())
+        m_Groups.Resize(groupIndex + 1);
+
+    if (!m_Groups[groupIndex])
+    {
+        m_Groups[groupIndex] = MakeUnique<Group<T>>();
+        m_Groups[groupIndex]->Stats = &TickStats::sGet().Register(TickStats::sTypeName<T>(), "ParallelFixedUpdate");
+    }
+
+    auto group = static_cast<Group<T>*>(m_Groups[groupIndex].RawPtr());
+
+    uint32_t id = group->AllocID();
+    group->Components.Add(component->GetOwner()->template GetComponentHandle<T>());
+
+    return (groupIndex << GroupShift) | id;
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,114 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "PlayerInputInterface.h"
+#include "../TraceProfiler.h"
+#include "../TickStats.h"
+#include "../Components/FirstPersonComponent.h"
+#include "../Components/ThirdPersonComponent.h"
+
+#include <Hork/Core/Logger.h>
+
+HK_NAMESPACE_BEGIN
+
+PlayerInputInterface::PlayerInputInterface()
+{}
+
+void PlayerInputInterface::Initialize()
+{
+    TickFunction f;
+    f.Desc.Name.FromString("Record/Replay Player Input");
+    f.Group = TickGroup::FixedUpdate;
+    f.OwnerTypeID = GetInterfaceTypeID() | (1 << 31);
+    f.Delegate.Bind(this, &PlayerInputInterface::FixedUpdate);
+    RegisterTickFunction(f);
+}
+
+void PlayerInputInterface::Deinitialize()
+{
+    m_Recorder = nullptr;
+    m_Replay = nullptr;
+    for (GameObjectHandle& player : m_Players)
+        player = {};
+}
+
+void PlayerInputInterface::SetPlayer(int index, GameObjectHandle player)
+{
+    HK_ASSERT(index >= 0 && index < MaxPlayers);
+    m_Players[index] = player;
+}
+
+void PlayerInputInterface::FixedUpdate()
+{
+    HK_TRACE_ZONE("FixedUpdate/PlayerInput");
+    HK_TICK_COST("PlayerInputInterface", "FixedUpdate");
+
+    World* world = GetWorld();
+
+    if (m_Replay && !m_Replay->IsFinished())
+    {
+        int playerCount = Math::Min(m_Replay->GetPlayerCount(), MaxPlayers);
+        for (int i = 0; i < playerCount; ++i)
+        {
+            GameObject* player = world->GetObject(m_Players[i]);
+            if (!player)
+                continue;
+
+            if (auto firstPerson = player->GetComponent<FirstPersonComponent>())
+                firstPerson->ReplayInput(m_Replay->GetInput(i));
+            else if (auto thirdPerson = player->GetComponent<ThirdPersonComponent>())
+                thirdPerson->ReplayInput(m_Replay->GetInput(i));
+        }
+
+        m_Replay->NextTick();
+        if (m_Replay->IsFinished())
+            LOG("Input replay finished after {} ticks\n", m_Replay->GetTickCount());
+    }
+
+    if (m_Recorder && m_Recorder->IsRecording())
+    {
+        m_Recorder->NextTick();
+
+        int playerCount = Math::Min(m_Recorder->GetPlayerCount(), MaxPlayers);
+        for (int i = 0; i < playerCount; ++i)
+        {
+            GameObject* player = world->GetObject(m_Players[i]);
+            if (!player)
+                continue;
+
+            if (auto firstPerson = player->GetComponent<FirstPersonComponent>())
+                m_Recorder->Record(i, firstPerson->TakeRecordedInput());
+            else if (auto thirdPerson = player->GetComponent<ThirdPersonComponent>())
+                m_Recorder->Record(i, thirdPerson->TakeRecordedInput());
+        }
+    }
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,67 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/World/World.h>
+
+#include "../InputRecording.h"
+
+HK_NAMESPACE_BEGIN
+
+// Connects player components to an InputRecorder or InputReplay. Runs once per fixed tick, before the
+// players' fixed update, so a recording holds one input frame per simulation tick whatever the frame rate.
+// Players are FirstPersonComponent or ThirdPersonComponent owners; the index is the player slot in the recording.
+class PlayerInputInterface : public WorldInterface
+{
+public:
+    static constexpr int MaxPlayers = 4;
+
+                        PlayerInputInterface();
+
+    // The recorder and the replay are owned by the caller and may outlive the world
+    void                SetRecorder(InputRecorder* recorder) { m_Recorder = recorder; }
+    void                SetReplay(InputReplay* replay) { m_Replay = replay; }
+
+    void                SetPlayer(int index, GameObjectHandle player);
+
+protected:
+    void                Initialize() override;
+    void                Deinitialize() override;
+
+private:
+    void                FixedUpdate();
+
+    InputRecorder*      m_Recorder{};
+    InputReplay*        m_Replay{};
+    GameObjectHandle    m_Players[MaxPlayers];
+};
+
+HK_NAMESPACE_END
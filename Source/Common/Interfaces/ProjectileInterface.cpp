@@ -0,0 +1,221 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "ProjectileInterface.h"
+#include "../TraceProfiler.h"
+#include "../TickStats.h"
+#include "../Components/ProjectileComponent.h"
+#include "../CollisionLayer.h"
+
+#include <Hork/World/Modules/Physics/Components/DynamicBodyComponent.h>
+#include <Hork/World/Modules/Render/Components/MeshComponent.h>
+#include <Hork/GameApplication/GameApplication.h>
+
+HK_NAMESPACE_BEGIN
+
+ProjectileInterface::ProjectileInterface()
+{}
+
+void ProjectileInterface::Initialize()
+{
+    m_Mesh = GameApplication::sGetResourceManager().GetResource<MeshResource>("/Root/default/sphere.mesh");
+
+    TickFunction f;
+    f.Desc.Name.FromString("Update Projectile Pool");
+    f.Group = TickGroup::FixedUpdate;
+    f.OwnerTypeID = GetInterfaceTypeID() | (1 << 31);
+    f.Delegate.Bind(this, &ProjectileInterface::FixedUpdate);
+    RegisterTickFunction(f);
+}
+
+void ProjectileInterface::Deinitialize()
+{
+    m_Mesh = {};
+    m_Slots.Clear();
+    m_FreeSlots.Clear();
+    m_PendingRelease.Clear();
+    m_ActiveCount = 0;
+}
+
+Float3 ProjectileInterface::GetParkingPosition(uint32_t slot) const
+{
+    // Far below the level, spread out so parked bodies never touch each other
+    return Float3(float(slot % 64) * 4, -10000, float(slot / 64) * 4);
+}
+
+uint32_t ProjectileInterface::CreateSlot()
+{
+    World* world = GetWorld();
+
+    uint32_t slotIndex = m_Slots.Size();
+    Slot& slot = m_Slots.EmplaceBack();
+
+    GameObjectDesc desc;
+    desc.Name.FromString("Projectile");
+    desc.Position = GetParkingPosition(slotIndex);
+    desc.Scale = Float3(0.2f);
+    desc.IsDynamic = true;
+    GameObject* object;
+    world->CreateObject(desc, object);
+    DynamicBodyComponent* phys;
+    slot.Body = object->CreateComponent(phys);
+    phys->CollisionLayer = CollisionLayer::Bullets;
+    phys->UseCCD = true;
+    phys->DispatchContactEvents = true;
+    phys->CanPushCharacter = false;
+    phys->SetKinematic(true);
+    SphereCollider* collider;
+    object->CreateComponent(collider);
+    collider->Radius = 0.5f;
+    DynamicMeshComponent* mesh;
+    slot.Mesh = object->CreateComponent(mesh);
+    mesh->SetMesh(m_Mesh);
+    mesh->SetLocalBoundingBox({Float3(-0.5f),Float3(0.5f)});
+    ProjectileComponent* projectile;
+    slot.Projectile = object->CreateComponent(projectile);
+    projectile->PoolSlot = slotIndex;
+
+    slot.Object = object->GetHandle();
+
+    return slotIndex;
+}
+
+void ProjectileInterface::Prewarm(int count)
+{
+    while (m_Slots.Size() < count)
+        m_FreeSlots.Add(CreateSlot());
+}
+
+void ProjectileInterface::Spawn(Float3 const& position, Float3 const& impulse, PlayerTeam team)
+{
+    auto& materialMngr = GameApplication::sGetMaterialManager();
+
+    World* world = GetWorld();
+
+    uint32_t slotIndex;
+    if (!m_FreeSlots.IsEmpty())
+    {
+        slotIndex = m_FreeSlots.Last();
+        m_FreeSlots.RemoveLast();
+    }
+    else
+        slotIndex = CreateSlot();
+
+    Slot& slot = m_Slots[slotIndex];
+
+    auto phys = world->GetComponent(slot.Body);
+    auto mesh = world->GetComponent(slot.Mesh);
+    auto projectile = world->GetComponent(slot.Projectile);
+    if (!phys || !mesh || !projectile)
+    {
+        // Return the slot to the pool instead of losing it
+        m_FreeSlots.Add(slotIndex);
+        return;
+    }
+
+    phys->SetWorldPosition(position);
+    phys->SetWorldRotation(Quat::sIdentity());
+    phys->SetKinematic(false);
+    phys->SetLinearVelocity(Float3(0));
+    phys->SetAngularVelocity(Float3(0));
+    phys->AddImpulse(impulse);
+
+    mesh->SetMaterial(materialMngr.TryGet(team == PlayerTeam::Blue ? "blank512" : "red512"));
+    mesh->SkipInterpolation();
+
+    projectile->Team = team;
+
+    slot.IsActive = true;
+    slot.Expire = world->GetInterface<TimerInterface>().Schedule(LifeTime, [this, slotIndex]() { OnExpired(slotIndex); });
+
+    m_ActiveCount++;
+}
+
+void ProjectileInterface::Release(uint32_t slotIndex)
+{
+    Slot& slot = m_Slots[slotIndex];
+    if (!slot.IsActive)
+        return;
+
+    slot.IsActive = false;
+
+    GetWorld()->GetInterface<TimerInterface>().Cancel(slot.Expire);
+    slot.Expire = 0;
+
+    // Contact events are dispatched from the physics update, move the body later
+    m_PendingRelease.Add(slotIndex);
+
+    m_ActiveCount--;
+}
+
+void ProjectileInterface::OnExpired(uint32_t slotIndex)
+{
+    Slot& slot = m_Slots[slotIndex];
+    slot.Expire = 0;
+
+    World* world = GetWorld();
+
+    GameObject* object = world->GetObject(slot.Object);
+    auto projectile = world->GetComponent(slot.Projectile);
+    if (object && projectile)
+        projectile->Explode(object->GetWorldPosition());
+    else
+        Release(slotIndex);
+}
+
+void ProjectileInterface::Park(uint32_t slotIndex)
+{
+    Slot& slot = m_Slots[slotIndex];
+
+    if (auto phys = GetWorld()->GetComponent(slot.Body))
+    {
+        phys->SetLinearVelocity(Float3(0));
+        phys->SetAngularVelocity(Float3(0));
+        phys->SetKinematic(true);
+        phys->SetWorldPosition(GetParkingPosition(slotIndex));
+    }
+
+    if (auto mesh = GetWorld()->GetComponent(slot.Mesh))
+        mesh->SkipInterpolation();
+
+    m_FreeSlots.Add(slotIndex);
+}
+
+void ProjectileInterface::FixedUpdate()
+{
+    HK_TRACE_ZONE("FixedUpdate/Projectiles");
+    HK_TICK_COST("ProjectileInterface", "FixedUpdate");
+
+    for (uint32_t slotIndex : m_PendingRelease)
+        Park(slotIndex);
+    m_PendingRelease.Clear();
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,96 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "TimerInterface.h"
+#include "../Components/PlayerTeam.h"
+
+#include <Hork/Resources/ResourceManager.h>
+
+HK_NAMESPACE_BEGIN
+
+class DynamicBodyComponent;
+class DynamicMeshComponent;
+class ProjectileComponent;
+
+// Per-world pool of projectile objects. Projectiles explode on contact or when their lifetime ends.
+// Exploded projectiles are parked far outside the level as kinematic bodies and reused,
+// so spawning doesn't create objects or physics bodies.
+class ProjectileInterface : public WorldInterface
+{
+public:
+    // Seconds before a projectile explodes in the air
+    float               LifeTime = 2;
+
+                        ProjectileInterface();
+
+    // Creates projectiles up front. Spawn() grows the pool when it runs out.
+    void                Prewarm(int count);
+
+    void                Spawn(Float3 const& position, Float3 const& impulse, PlayerTeam team);
+
+    // Returns the projectile to the pool at the next fixed step
+    void                Release(uint32_t slot);
+
+    bool                IsActive(uint32_t slot) const { return m_Slots[slot].IsActive; }
+
+    int                 GetPoolSize() const { return m_Slots.Size(); }
+    int                 GetActiveCount() const { return m_ActiveCount; }
+
+protected:
+    void                Initialize() override;
+    void                Deinitialize() override;
+
+private:
+    struct Slot
+    {
+        GameObjectHandle Object;
+        Handle32<DynamicBodyComponent> Body;
+        Handle32<DynamicMeshComponent> Mesh;
+        Handle32<ProjectileComponent> Projectile;
+        TimerID         Expire{};
+        bool            IsActive = false;
+    };
+
+    void                FixedUpdate();
+    void                OnExpired(uint32_t slot);
+    uint32_t            CreateSlot();
+    void                Park(uint32_t slot);
+    Float3              GetParkingPosition(uint32_t slot) const;
+
+    MeshHandle          m_Mesh;
+    Vector<Slot>        m_Slots;
+    Vector<uint32_t>    m_FreeSlots;
+    Vector<uint32_t>    m_PendingRelease;
+    int                 m_ActiveCount = 0;
+};
+
+HK_NAMESPACE_END
@@ -0,0 +1,58 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "TickCounterInterface.h"
+
+HK_NAMESPACE_BEGIN
+
+std::atomic<uint64_t> TickCounterInterface::sTickNum{0};
+
+TickCounterInterface::TickCounterInterface()
+{}
+
+void TickCounterInterface::Initialize()
+{
+    TickFunction f;
+    f.Desc.Name.FromString("Count Fixed Ticks");
+    f.Group = TickGroup::FixedUpdate;
+    f.OwnerTypeID = GetInterfaceTypeID() | (1 << 31);
+    f.Delegate.Bind(this, &TickCounterInterface::FixedUpdate);
+    RegisterTickFunction(f);
+}
+
+void TickCounterInterface::Deinitialize()
+{}
+
+void TickCounterInterface::FixedUpdate()
+{
+    sTickNum.fetch_add(1, std::memory_order_relaxed);
+}
+
+HK_NAMESPACE_END
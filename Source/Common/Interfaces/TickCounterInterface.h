@@ -0,0 +1,59 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/World/World.h>
+
+#include <atomic>
+
+HK_NAMESPACE_BEGIN
+
+// Counts fixed ticks of the worlds it is added to. HeadlessRunner uses it so that a run is measured
+// in simulation ticks rather than in frames. Paused worlds don't tick and are not counted.
+class TickCounterInterface : public WorldInterface
+{
+public:
+                        TickCounterInterface();
+
+    // Fixed ticks of all worlds since startup
+    static uint64_t     sGetTickNum() { return sTickNum.load(std::memory_order_relaxed); }
+
+protected:
+    void                Initialize() override;
+    void                Deinitialize() override;
+
+private:
+    void                FixedUpdate();
+
+    static std::atomic<uint64_t> sTickNum;
+};
+
+HK_NAMESPACE_END
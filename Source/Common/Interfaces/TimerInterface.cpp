@@ -0,0 +1,212 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "TimerInterface.h"
+#include "../TraceProfiler.h"
+#include "../TickStats.h"
+
+HK_NAMESPACE_BEGIN
+
+TimerInterface::TimerInterface()
+{
+    for (int32_t& slot : m_Slots)
+        slot = -1;
+}
+
+void TimerInterface::Initialize()
+{
+    TickFunction f;
+    f.Desc.Name.FromString("Update Timers");
+    f.Group = TickGroup::FixedUpdate;
+    f.OwnerTypeID = GetInterfaceTypeID() | (1 << 31);
+    f.Delegate.Bind(this, &TimerInterface::FixedUpdate);
+    RegisterTickFunction(f);
+}
+
+void TimerInterface::Deinitialize()
+{
+    m_Nodes.Clear();
+    m_FreeNodes.Clear();
+    for (int32_t& slot : m_Slots)
+        slot = -1;
+    m_PendingCount = 0;
+}
+
+TimerID TimerInterface::Schedule(float delay, Callback callback)
+{
+    float timeStep = GetWorld()->GetTick().FixedTimeStep;
+
+    uint64_t ticks = uint64_t(Math::Ceil(delay / timeStep));
+    if (ticks < 1)
+        ticks = 1;
+
+    int32_t nodeIndex;
+    if (!m_FreeNodes.IsEmpty())
+    {
+        nodeIndex = m_FreeNodes.Last();
+        m_FreeNodes.RemoveLast();
+    }
+    else
+    {
+        nodeIndex = m_Nodes.Size();
+        Node& node = m_Nodes.EmplaceBack();
+        node.Generation = 1;
+    }
+
+    Node& node = m_Nodes[nodeIndex];
+    node.Deadline = m_CurrentTick + ticks;
+    node.Func = std::move(callback);
+
+    Insert(nodeIndex);
+    m_PendingCount++;
+
+    return (TimerID(node.Generation) << 32) | uint32_t(nodeIndex);
+}
+
+void TimerInterface::Cancel(TimerID id)
+{
+    if (!IsPending(id))
+        return;
+
+    int32_t nodeIndex = int32_t(id & 0xffffffff);
+
+    Unlink(nodeIndex);
+    FreeNode(nodeIndex);
+}
+
+bool TimerInterface::IsPending(TimerID id) const
+{
+    uint32_t nodeIndex = uint32_t(id & 0xffffffff);
+    uint32_t generation = uint32_t(id >> 32);
+
+    return nodeIndex < uint32_t(m_Nodes.Size()) && m_Nodes[nodeIndex].Generation == generation && m_Nodes[nodeIndex].Slot >= 0;
+}
+
+void TimerInterface::Insert(int32_t nodeIndex)
+{
+    Node& node = m_Nodes[nodeIndex];
+
+    uint64_t delta = node.Deadline - m_CurrentTick;
+
+    // Pick the finest level whose range covers the delay
+    int level = 0;
+    while (level < LevelCount - 1 && delta >= (uint64_t(1) << ((level + 1) * LevelBits)))
+        ++level;
+
+    // Delays beyond the wheel range wait in the last slot of the top level and are cascaded again
+    uint64_t deadline = node.Deadline;
+    if (level == LevelCount - 1 && delta >= (uint64_t(1) << (LevelCount * LevelBits)))
+        deadline = m_CurrentTick + (uint64_t(1) << (LevelCount * LevelBits)) - 1;
+
+    int32_t slot = level * SlotsPerLevel + int32_t((deadline >> (level * LevelBits)) & SlotMask);
+
+    node.Slot = slot;
+    node.Prev = -1;
+    node.Next = m_Slots[slot];
+    if (node.Next >= 0)
+        m_Nodes[node.Next].Prev = nodeIndex;
+    m_Slots[slot] = nodeIndex;
+}
+
+void TimerInterface::Unlink(int32_t nodeIndex)
+{
+    Node& node = m_Nodes[nodeIndex];
+
+    if (node.Prev >= 0)
+        m_Nodes[node.Prev].Next = node.Next;
+    else
+        m_Slots[node.Slot] = node.Next;
+
+    if (node.Next >= 0)
+        m_Nodes[node.Next].Prev = node.Prev;
+
+    node.Slot = -1;
+}
+
+void TimerInterface::FreeNode(int32_t nodeIndex)
+{
+    Node& node = m_Nodes[nodeIndex];
+
+    node.Func = {};
+    node.Slot = -1;
+    node.Generation++;
+
+    m_FreeNodes.Add(nodeIndex);
+    m_PendingCount--;
+}
+
+void TimerInterface::Cascade(int level)
+{
+    int32_t slot = level * SlotsPerLevel + int32_t((m_CurrentTick >> (level * LevelBits)) & SlotMask);
+
+    // Redistribute the slot to finer levels
+    int32_t nodeIndex = m_Slots[slot];
+    m_Slots[slot] = -1;
+
+    while (nodeIndex >= 0)
+    {
+        int32_t next = m_Nodes[nodeIndex].Next;
+        Insert(nodeIndex);
+        nodeIndex = next;
+    }
+}
+
+void TimerInterface::FixedUpdate()
+{
+    HK_TRACE_ZONE("FixedUpdate/Timers");
+    HK_TICK_COST("TimerInterface", "FixedUpdate");
+
+    m_CurrentTick++;
+
+    // When a level wraps around, bring the next slot of the coarser level down
+    for (int level = 1; level < LevelCount; ++level)
+    {
+        if ((m_CurrentTick & ((uint64_t(1) << (level * LevelBits)) - 1)) != 0)
+            break;
+        Cascade(level);
+    }
+
+    int32_t slot = int32_t(m_CurrentTick & SlotMask);
+
+    // Callbacks may schedule or cancel timers, so take nodes one by one
+    while (m_Slots[slot] >= 0)
+    {
+        int32_t nodeIndex = m_Slots[slot];
+
+        Callback callback = std::move(m_Nodes[nodeIndex].Func);
+
+        Unlink(nodeIndex);
+        FreeNode(nodeIndex);
+
+        callback();
+    }
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,94 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/World/World.h>
+
+#include <functional>
+
+HK_NAMESPACE_BEGIN
+
+// Generation in the high bits, node index in the low bits. Zero is never a valid timer.
+using TimerID = uint64_t;
+
+// Hierarchical timing wheel with a resolution of one fixed step. Waiting timers cost nothing per tick;
+// scheduling, cancelling and firing are O(1), plus an amortized O(1) cascade for long delays.
+class TimerInterface : public WorldInterface
+{
+public:
+    using Callback = std::function<void()>;
+
+                        TimerInterface();
+
+    // Calls the callback after the delay in seconds, rounded up to whole fixed steps (at least one)
+    TimerID             Schedule(float delay, Callback callback);
+
+    // Safe to call with fired or already cancelled timers
+    void                Cancel(TimerID id);
+
+    bool                IsPending(TimerID id) const;
+
+    int                 GetPendingCount() const { return m_PendingCount; }
+
+protected:
+    void                Initialize() override;
+    void                Deinitialize() override;
+
+private:
+    static constexpr int LevelBits = 8;
+    static constexpr int SlotsPerLevel = 1 << LevelBits;
+    static constexpr int SlotMask = SlotsPerLevel - 1;
+    static constexpr int LevelCount = 4;
+
+    struct Node
+    {
+        uint64_t        Deadline;
+        Callback        Func;
+        int32_t         Prev;
+        int32_t         Next;
+        int32_t         Slot;
+        uint32_t        Generation;
+    };
+
+    void                FixedUpdate();
+    void                Insert(int32_t nodeIndex);
+    void                Unlink(int32_t nodeIndex);
+    void                Cascade(int level);
+    void                FreeNode(int32_t nodeIndex);
+
+    Vector<Node>        m_Nodes;
+    Vector<int32_t>     m_FreeNodes;
+    int32_t             m_Slots[LevelCount * SlotsPerLevel];
+    uint64_t            m_CurrentTick = 0;
+    int                 m_PendingCount = 0;
+};
+
+HK_NAMESPACE_END
@@ -0,0 +1,137 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "JobPool.h"
+#include "TraceProfiler.h"
+
+HK_NAMESPACE_BEGIN
+
+JobPool& JobPool::sGet()
+{
+    static JobPool pool;
+    return pool;
+}
+
+JobPool::JobPool()
+{
+    // Leave one core to the main thread
+    int workerCount = int(std::thread::hardware_concurrency()) - 1;
+    if (workerCount > 7)
+        workerCount = 7;
+
+    for (int i = 0; i < workerCount; ++i)
+        m_Workers.EmplaceBack([this]() { WorkerMain(); });
+}
+
+JobPool::~JobPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_WakeWorkers.notify_all();
+
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+void JobPool::ParallelFor(int count, int batchSize, RangeJob const& job)
+{
+    if (count <= 0)
+        return;
+
+    if (batchSize < 1)
+        batchSize = 1;
+
+    // Not worth waking the workers
+    if (m_Workers.IsEmpty() || count <= batchSize)
+    {
+        job(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Job = &job;
+        m_Count = count;
+        m_BatchSize = batchSize;
+        m_NextIndex.store(0, std::memory_order_relaxed);
+        m_BusyWorkers = m_Workers.Size();
+        m_Generation++;
+    }
+    m_WakeWorkers.notify_all();
+
+    RunBatches();
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_WorkersDone.wait(lock, [this]() { return m_BusyWorkers == 0; });
+    m_Job = nullptr;
+}
+
+void JobPool::RunBatches()
+{
+    while (true)
+    {
+        int first = m_NextIndex.fetch_add(m_BatchSize, std::memory_order_relaxed);
+        if (first >= m_Count)
+            break;
+
+        int last = first + m_BatchSize;
+        if (last > m_Count)
+            last = m_Count;
+
+        HK_TRACE_ZONE("JobPool batch");
+        (*m_Job)(first, last);
+    }
+}
+
+void JobPool::WorkerMain()
+{
+    uint32_t generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WakeWorkers.wait(lock, [this, generation]() { return m_Stop || m_Generation != generation; });
+            if (m_Stop)
+                return;
+            generation = m_Generation;
+        }
+
+        RunBatches();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (--m_BusyWorkers == 0)
+            m_WorkersDone.notify_one();
+    }
+}
+
+HK_NAMESPACE_END
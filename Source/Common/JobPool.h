@@ -0,0 +1,82 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/Core/Containers/Vector.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+HK_NAMESPACE_BEGIN
+
+// Persistent worker threads for data-parallel loops in gameplay code.
+// The calling thread takes part in the work, so the pool is useful even with few cores.
+class JobPool final
+{
+public:
+    // Processes the range [first, last)
+    using RangeJob = std::function<void(int first, int last)>;
+
+    static JobPool&     sGet();
+
+    int                 GetWorkerCount() const { return m_Workers.Size(); }
+
+    // Splits [0, count) into batches and runs them on the workers and the calling thread.
+    // Returns when all batches are done. Not reentrant; call from one thread at a time.
+    void                ParallelFor(int count, int batchSize, RangeJob const& job);
+
+                        JobPool(JobPool const&) = delete;
+    JobPool&            operator=(JobPool const&) = delete;
+
+private:
+                        JobPool();
+                        ~JobPool();
+
+    void                WorkerMain();
+    void                RunBatches();
+
+    Vector<std::thread> m_Workers;
+    std::mutex          m_Mutex;
+    std::condition_variable m_WakeWorkers;
+    std::condition_variable m_WorkersDone;
+    RangeJob const*     m_Job{};
+    std::atomic<int>    m_NextIndex{0};
+    int                 m_Count = 0;
+    int                 m_BatchSize = 1;
+    uint32_t            m_Generation = 0;
+    int                 m_BusyWorkers = 0;
+    bool                m_Stop = false;
+};
+
+HK_NAMESPACE_END
@@ -0,0 +1,177 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "LevelLoader.h"
+#include "TraceProfiler.h"
+#include "MemoryTags.h"
+#include "Interfaces/DestructionInterface.h"
+
+#include <Hork/Core/Logger.h>
+#include <Hork/GameApplication/GameApplication.h>
+
+HK_NAMESPACE_BEGIN
+
+void LevelLoader::Begin(World* world, StringView mapFilename, ArrayView<ResourceID> resources, PopulateCallback populate, MapGeometrySettings const& settings)
+{
+    HK_ASSERT(m_State == State::Empty);
+
+    auto& resourceMngr = GameApplication::sGetResourceManager();
+
+    m_World = world;
+    m_World->SetPaused(true);
+
+    m_MapFilename = mapFilename;
+
+    // Peaks of the report cover this load only. Other loads running at the same time have their own report.
+    m_MemoryReport.Reset();
+    m_MapLoader.SetMemoryReport(&m_MemoryReport);
+
+    m_Populate = std::move(populate);
+
+    m_HasResources = !resources.IsEmpty();
+    if (m_HasResources)
+    {
+        m_Resources = resourceMngr.CreateResourceArea(resources);
+        resourceMngr.LoadArea(m_Resources);
+    }
+
+    if (Streaming)
+    {
+        // Worldspawn is clustered by the sector grid
+        MapGeometrySettings streamingSettings = settings;
+        streamingSettings.ClusterSize = m_Streamer.SectorSize;
+
+        m_MapLoader.LoadAsync(mapFilename, streamingSettings, MapLoadMode::Streaming);
+    }
+    else
+        m_MapLoader.LoadAsync(mapFilename, settings);
+
+    m_State = State::Loading;
+}
+
+bool LevelLoader::Update()
+{
+    HK_TRACE_ZONE("LevelLoader::Update");
+
+    auto& resourceMngr = GameApplication::sGetResourceManager();
+
+    if (m_State == State::Loading)
+    {
+        if (m_HasResources && !resourceMngr.IsAreaReady(m_Resources))
+            return false;
+
+        if (!m_MapLoader.IsReady())
+            return false;
+
+        if (m_MapLoader.IsFailed())
+        {
+            LOG("LevelLoader: Failed to load {}\n", m_MapFilename);
+            m_State = State::Failed;
+            return false;
+        }
+
+        if (Streaming)
+            m_MapLoader.StartStreaming(m_World, m_Streamer);
+        else
+            m_MapLoader.CreateScene(m_World, m_Queue);
+        if (m_Populate)
+            m_Populate(m_World, m_Queue);
+
+        m_State = State::Constructing;
+    }
+
+    if (Streaming)
+        m_Streamer.Update();
+
+    if (m_State == State::Constructing)
+    {
+        m_Queue.BudgetMs = BudgetMs;
+        if (m_Queue.Process() && !m_Streamer.IsLoading())
+        {
+            m_State = State::Ready;
+
+            m_MemoryReport.Print(m_MapFilename);
+        }
+    }
+
+    return m_State == State::Ready;
+}
+
+float LevelLoader::GetProgress() const
+{
+    switch (m_State)
+    {
+        case State::Constructing:
+            return m_Queue.GetProgress();
+        case State::Ready:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+void LevelLoader::Activate()
+{
+    HK_ASSERT(m_State == State::Ready);
+
+    m_World->SetPaused(false);
+}
+
+void LevelLoader::StopStreaming()
+{
+    m_Streamer.Deinitialize();
+}
+
+void LevelLoader::Unload()
+{
+    auto& resourceMngr = GameApplication::sGetResourceManager();
+
+    // Drop pending construction tasks, they reference the world being torn down
+    m_Queue.Clear();
+
+    // The map objects are destroyed in one batch, then the loader releases their meshes
+    if (m_World)
+    {
+        m_MapLoader.DestroyScene(m_World);
+        m_World->GetInterface<DestructionInterface>().Flush();
+    }
+
+    if (m_HasResources)
+    {
+        resourceMngr.UnloadArea(m_Resources);
+        m_HasResources = false;
+    }
+
+    m_Populate = {};
+    m_World = nullptr;
+    m_State = State::Empty;
+}
+
+HK_NAMESPACE_END
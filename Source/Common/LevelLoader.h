@@ -0,0 +1,105 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "MapParser/Utils.h"
+#include "SceneConstructionQueue.h"
+
+#include <Hork/Core/Containers/ArrayView.h>
+
+HK_NAMESPACE_BEGIN
+
+// Prepares a level in the background while another world is running: loads the resource area,
+// parses and builds the map on a worker thread and constructs the scene in a paused world,
+// spending a few milliseconds per frame. Activating a ready level is just unpausing its world.
+// With Streaming, the map is created by sectors around the streamer sources instead; the level is
+// ready when the sectors near the sources added by the populate callback are loaded.
+class LevelLoader final
+{
+public:
+    // Adds level specific objects to the construction queue
+    using PopulateCallback = std::function<void(World* world, SceneConstructionQueue& queue)>;
+
+    // Time budget of scene construction per frame in milliseconds
+    float               BudgetMs = 2;
+
+    // Stream the map with GetStreamer() instead of creating it at once
+    bool                Streaming = false;
+
+    // Starts loading the level into the world. The world is paused until Activate().
+    void                Begin(World* world, StringView mapFilename, ArrayView<ResourceID> resources, PopulateCallback populate = {}, MapGeometrySettings const& settings = {});
+
+    // Advances loading and streaming. Call once per frame on the main thread. Returns true when the level is ready.
+    bool                Update();
+
+    bool                IsLoading() const { return m_State == State::Loading || m_State == State::Constructing; }
+    bool                IsReady() const { return m_State == State::Ready; }
+    bool                IsFailed() const { return m_State == State::Failed; }
+
+    float               GetProgress() const;
+
+    World*              GetWorld() const { return m_World; }
+
+    MapStreamer&        GetStreamer() { return m_Streamer; }
+
+    // Unpauses the world of the ready level
+    void                Activate();
+
+    // Unloads the streamed sectors. Call before destroying the world.
+    void                StopStreaming();
+
+    // Destroys the map objects and releases the level resources. Destroy the world right after calling this.
+    void                Unload();
+
+private:
+    enum class State
+    {
+        Empty,
+        Loading,
+        Constructing,
+        Ready,
+        Failed
+    };
+
+    State               m_State = State::Empty;
+    World*              m_World{};
+    String              m_MapFilename;
+    // Declared before the loader and the streamer, which add to it until they are destroyed
+    MemoryReport        m_MemoryReport;
+    MapLoader           m_MapLoader;
+    MapStreamer         m_Streamer;
+    SceneConstructionQueue m_Queue;
+    ResourceAreaID      m_Resources;
+    bool                m_HasResources = false;
+    PopulateCallback    m_Populate;
+};
+
+HK_NAMESPACE_END
@@ -0,0 +1,214 @@
+﻿/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "MapGenerator.h"
+#include "../Pcg32.h"
+
+#include <Hork/Core/Logger.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+HK_NAMESPACE_BEGIN
+
+namespace
+{
+
+// Map units, 32 per meter
+constexpr int CellSize = 64;
+constexpr int Step = 16;
+constexpr int EntitySpacing = 256;
+
+// The same PCG32 as RandomInterface, so the same settings give the same map everywhere
+class MapRandom
+{
+public:
+    explicit MapRandom(uint32_t seed) :
+        m_Random(seed)
+    {}
+
+    // Random integer in range [0..count)
+    int Get(int count)
+    {
+        return int(m_Random.Get() % uint32_t(count));
+    }
+
+private:
+    Pcg32 m_Random;
+};
+
+class MapWriter
+{
+public:
+    MapWriter(FILE* file, int materialCount) :
+        m_File(file),
+        m_MaterialCount(materialCount)
+    {}
+
+    void BeginEntity(const char* className)
+    {
+        fprintf(m_File, "// entity %d\n{\n\"classname\" \"%s\"\n", m_EntityNum++, className);
+        m_BrushNum = 0;
+    }
+
+    void EndEntity()
+    {
+        fprintf(m_File, "}\n");
+    }
+
+    void PointEntity(const char* className, int x, int y, int z)
+    {
+        BeginEntity(className);
+        fprintf(m_File, "\"origin\" \"%d %d %d\"\n", x, y, z);
+        EndEntity();
+    }
+
+    // Face points follow the winding of the shipped maps
+    void Box(int x0, int y0, int z0, int x1, int y1, int z1, int material)
+    {
+        BeginBrush();
+        Face(x0, y0, z0, x0, y0 + 1, z0, x0, y0, z0 + 1, material);
+        Face(x0, y0, z0, x0, y0, z0 + 1, x0 + 1, y0, z0, material);
+        Face(x0, y0, z0, x0 + 1, y0, z0, x0, y0 + 1, z0, material);
+        Face(x1, y1, z1, x1, y1 + 1, z1, x1 + 1, y1, z1, material);
+        Face(x1, y1, z1, x1 + 1, y1, z1, x1, y1, z1 + 1, material);
+        Face(x1, y1, z1, x1, y1, z1 + 1, x1, y1 + 1, z1, material);
+        EndBrush();
+    }
+
+    // Ramp rising along X from z0 at x0 to z1 at x1
+    void Ramp(int x0, int y0, int z0, int x1, int y1, int z1, int material)
+    {
+        BeginBrush();
+        Face(x0, y0, z0, x0, y0, z0 + 1, x0 + 1, y0, z0, material);
+        Face(x0, y0, z0, x0 + 1, y0, z0, x0, y0 + 1, z0, material);
+        Face(x0, y0, z0, x0, y1, z0, x1, y0, z1, material);
+        Face(x1, y1, z1, x1 + 1, y1, z1, x1, y1, z1 + 1, material);
+        Face(x1, y1, z1, x1, y1, z1 + 1, x1, y1 + 1, z1, material);
+        EndBrush();
+    }
+
+    int GetBrushCount() const { return m_TotalBrushes; }
+
+private:
+    void BeginBrush()
+    {
+        fprintf(m_File, "// brush %d\n{\n", m_BrushNum++);
+        ++m_TotalBrushes;
+    }
+
+    void EndBrush()
+    {
+        fprintf(m_File, "}\n");
+    }
+
+    void Face(int ax, int ay, int az, int bx, int by, int bz, int cx, int cy, int cz, int material)
+    {
+        fprintf(m_File, "( %d %d %d ) ( %d %d %d ) ( %d %d %d ) generated/material%d 0 0 0 1 1\n",
+                ax, ay, az, bx, by, bz, cx, cy, cz, material % m_MaterialCount);
+    }
+
+    FILE* m_File;
+    int m_MaterialCount;
+    int m_EntityNum = 0;
+    int m_BrushNum = 0;
+    int m_TotalBrushes = 0;
+};
+
+}
+
+bool GenerateMap(StringView filename, MapGeneratorSettings const& settings)
+{
+    String name(filename);
+    FILE* file = fopen(name.CStr(), "w");
+    if (!file)
+    {
+        LOG("GenerateMap: Failed to write {}\n", name);
+        return false;
+    }
+
+    int materialCount = std::max(settings.MaterialCount, 1);
+    int gridSize = std::max(int(std::ceil(std::sqrt(double(settings.BrushCount)))), 1);
+
+    MapRandom random(settings.Seed);
+    MapWriter writer(file, materialCount);
+
+    fprintf(file, "// Game: Generic\n// Format: Standard\n");
+
+    writer.BeginEntity("worldspawn");
+    for (int brushNum = 0; brushNum < settings.BrushCount; ++brushNum)
+    {
+        int cellX = brushNum % gridSize * CellSize;
+        int cellY = brushNum / gridSize * CellSize;
+
+        // Sizes and offsets on a 16 unit grid, so neighbours often touch and their hulls can merge
+        int sizeX = Step * (2 + random.Get(3));
+        int sizeY = Step * (2 + random.Get(3));
+        int x0 = cellX + Step * random.Get((CellSize - sizeX) / Step + 1);
+        int y0 = cellY + Step * random.Get((CellSize - sizeY) / Step + 1);
+        int height = Step * (1 + random.Get(16));
+        int material = random.Get(materialCount);
+
+        if (settings.RampInterval > 0 && brushNum % settings.RampInterval == settings.RampInterval - 1)
+            writer.Ramp(x0, y0, 0, x0 + sizeX, y0 + sizeY, height, material);
+        else
+            writer.Box(x0, y0, 0, x0 + sizeX, y0 + sizeY, height, material);
+    }
+    writer.EndEntity();
+
+    // Entities go in rows below the grid
+    int entitiesPerRow = std::max(gridSize * CellSize / EntitySpacing, 1);
+    for (int entityNum = 0; entityNum < settings.EntityCount; ++entityNum)
+    {
+        int x = entityNum % entitiesPerRow * EntitySpacing;
+        int y = -EntitySpacing * (1 + entityNum / entitiesPerRow);
+        int shape = entityNum % 4;
+
+        writer.BeginEntity("func_wall");
+        for (int brushNum = 0; brushNum < settings.EntityBrushCount; ++brushNum)
+        {
+            int z = brushNum * Step * 2;
+            int width = Step * (2 + shape) - Step * (brushNum % 2);
+            writer.Box(x, y, z, x + width, y + CellSize, z + Step * 2, shape + brushNum);
+        }
+        writer.EndEntity();
+    }
+
+    writer.PointEntity("info_player_start", CellSize / 2, CellSize / 2, Step * 20);
+
+    long size = ftell(file);
+    fclose(file);
+
+    LOG("Generated {}: {} brushes, {} entities, {} KB\n", name, writer.GetBrushCount(), settings.EntityCount + 2, size / 1024);
+    return true;
+}
+
+HK_NAMESPACE_END
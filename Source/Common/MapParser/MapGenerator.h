@@ -0,0 +1,62 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/Core/String.h>
+
+HK_NAMESPACE_BEGIN
+
+struct MapGeneratorSettings
+{
+    // Brushes of worldspawn, one per cell of a square grid. Most are boxes of random size and height.
+    int                 BrushCount = 1000;
+
+    // Every Nth worldspawn brush is a ramp with a sloped face. Zero disables ramps.
+    int                 RampInterval = 4;
+
+    // Brush entities (func_wall) in rows next to the grid. They come in four shapes, so geometry instancing applies.
+    int                 EntityCount = 0;
+
+    // Brushes of each entity
+    int                 EntityBrushCount = 4;
+
+    // Distinct material names, picked per brush
+    int                 MaterialCount = 8;
+
+    uint32_t            Seed = 1;
+};
+
+// Writes a map of the given size in the standard format, like the maps in Data, for parser and geometry
+// benchmarks. Patches are not written since MapParser reads brushes only. Returns false if the file
+// can't be written.
+bool GenerateMap(StringView filename, MapGeneratorSettings const& settings);
+
+HK_NAMESPACE_END
@@ -29,31 +29,43 @@ SOFTWARE.
 */
 
 #include "MapGeometry.h"
+#include "../TraceProfiler.h"
 
 #include <Hork/Core/Logger.h>
+#include <Hork/Core/String.h>
 #include <Hork/Geometry/ConvexHull.h>
-#include <Hork/Geometry/ConvexDecomposition.h>
 #include <Hork/Geometry/TangentSpace.h>
 
 HK_NAMESPACE_BEGIN
 
-void MapGeometry::Build(MapParser const& parser)
+void MapGeometry::Build(MapParser const& parser, MapGeometrySettings const& settings)
 {
+    HK_TRACE_ZONE("MapGeometry::Build");
+
+    m_SourceClipHullCount = 0;
+
     auto& entities = parser.GetEntities();
     auto& brushes = parser.GetBrushes();
     auto& faces = parser.GetFaces();
 
-    Vector<FaceInfo> faceInfos;
+    struct ClusterBrush
+    {
+        int64_t     Cell;
+        int         BrushNum;
+        int         HullNum;
+    };
+
+    Vector<int> brushList;
+    Vector<int> hullList;
+    Vector<ClusterBrush> clusterBrushes;
 
     m_Entities.Reserve(entities.Size());
 
-    for (auto const& entity : entities)
+    for (int entityNum = 0; entityNum < entities.Size(); ++entityNum)
     {
-        auto& entityGeom = m_Entities.EmplaceBack();
-        entityGeom.FirstSurface = m_Surfaces.Size();
-        entityGeom.FirstClipHull = m_ClipHulls.Size();
+        auto& entity = entities[entityNum];
 
-        faceInfos.Clear();
+        brushList.Clear();
 
         for (int brushNum = 0; brushNum < entity.BrushCount; ++brushNum)
         {
@@ -65,25 +77,150 @@ void MapGeometry::Build(MapParser const& parser)
                 continue;
             }
 
-            for (int faceNum = 0; faceNum < brush.FaceCount; ++faceNum)
+            brushList.Add(entity.FirstBrush + brushNum);
+        }
+
+        if (settings.ClusterSize > 0 && brushList.Size() > 1 && !Core::Stricmp(entity.ClassName, "worldspawn"))
+        {
+            // Clip hulls are extracted once up front. Their bounds give the cell of the brush and the clusters copy them.
+            MapGeometry brushHulls;
+            brushHulls.SetMemoryReport(m_Memory.GetReport());
+
+            // Group brushes by the grid cell of their center
+            clusterBrushes.Clear();
+            for (int brushNum : brushList)
             {
-                auto& face = faces[brush.FirstFace + faceNum];
+                int hullNum = brushHulls.m_ClipHulls.Size();
+                brushHulls.ExtractClipHull(brushes[brushNum], faces);
 
-                auto& faceInfo = faceInfos.EmplaceBack();
-                faceInfo.FaceNum = brush.FirstFace + faceNum;
-                faceInfo.Brush = &brush;
-                faceInfo.Material = face.Material;
+                BvAxisAlignedBox bounds;
+                bounds.Clear();
+                if (hullNum < brushHulls.m_ClipHulls.Size())
+                {
+                    auto& hull = brushHulls.m_ClipHulls[hullNum];
+                    for (int v = 0; v < hull.VertexCount; ++v)
+                        bounds.AddPoint(brushHulls.m_ClipVertices[hull.FirstVert + v]);
+                }
+                else
+                {
+                    hullNum = -1;
+                    bounds.AddPoint(Float3(0));
+                }
+
+                Float3 center = bounds.Center();
+
+                int32_t x = int32_t(Math::Floor(center.X / settings.ClusterSize));
+                int32_t z = int32_t(Math::Floor(center.Z / settings.ClusterSize));
+
+                clusterBrushes.Add({(int64_t(x) << 32) | uint32_t(z), brushNum, hullNum});
             }
+            brushHulls.UpdateMemory();
 
-            ExtractClipHull(brush, faces);
+            std::sort(clusterBrushes.begin(), clusterBrushes.end(), [](ClusterBrush const& a, ClusterBrush const& b) { return a.Cell < b.Cell || (a.Cell == b.Cell && a.BrushNum < b.BrushNum); });
+
+            hullList.Resize(clusterBrushes.Size());
+            for (int i = 0; i < clusterBrushes.Size(); ++i)
+            {
+                brushList[i] = clusterBrushes[i].BrushNum;
+                hullList[i] = clusterBrushes[i].HullNum;
+            }
+
+            for (int first = 0; first < clusterBrushes.Size();)
+            {
+                int last = first + 1;
+                while (last < clusterBrushes.Size() && clusterBrushes[last].Cell == clusterBrushes[first].Cell)
+                    ++last;
+
+                BuildEntity(entityNum, &brushList[first], last - first, parser, settings, &brushHulls, &hullList[first]);
+                UpdateMemory();
+
+                first = last;
+            }
+        }
+        else
+        {
+            BuildEntity(entityNum, brushList.ToPtr(), brushList.Size(), parser, settings);
+            UpdateMemory();
         }
+    }
+
+    m_MergedClipHullCount = m_ClipHulls.Size();
+
+    if (settings.InstanceEntities)
+        InstanceEntities(settings.InstanceTolerance);
+
+    UpdateMemory();
+}
 
-        std::sort(faceInfos.begin(), faceInfos.end(), [](FaceInfo const& a, FaceInfo const& b) { return a.Material < b.Material; });
+void MapGeometry::UpdateMemory()
+{
+    m_Memory.Set(GetContainerBytes(m_Surfaces) +
+                 GetContainerBytes(m_Vertices) +
+                 GetContainerBytes(m_Indices) +
+                 GetContainerBytes(m_ClipVertices) +
+                 GetContainerBytes(m_ClipIndices) +
+                 GetContainerBytes(m_ClipHulls) +
+                 GetContainerBytes(m_ClipPlanes) +
+                 GetContainerBytes(m_Entities));
+}
+
+void MapGeometry::BuildEntity(int sourceEntity, int const* brushNums, int brushCount, MapParser const& parser, MapGeometrySettings const& settings, MapGeometry const* hullSource, int const* hullNums)
+{
+    auto& brushes = parser.GetBrushes();
+    auto& faces = parser.GetFaces();
+
+    Vector<FaceInfo> faceInfos;
 
-        ExtractSurfaces(faceInfos, faces);
+    auto& entityGeom = m_Entities.EmplaceBack();
+    entityGeom.FirstSurface = m_Surfaces.Size();
+    entityGeom.FirstClipHull = m_ClipHulls.Size();
+    entityGeom.Prototype = m_Entities.Size() - 1;
+    entityGeom.SourceEntity = sourceEntity;
 
-        entityGeom.SurfaceCount = m_Surfaces.Size() - entityGeom.FirstSurface;
-        entityGeom.ClipHullCount = m_ClipHulls.Size() - entityGeom.FirstClipHull;
+    for (int i = 0; i < brushCount; ++i)
+    {
+        auto& brush = brushes[brushNums[i]];
+
+        for (int faceNum = 0; faceNum < brush.FaceCount; ++faceNum)
+        {
+            auto& face = faces[brush.FirstFace + faceNum];
+
+            auto& faceInfo = faceInfos.EmplaceBack();
+            faceInfo.FaceNum = brush.FirstFace + faceNum;
+            faceInfo.Brush = &brush;
+            faceInfo.Material = face.Material;
+        }
+
+        if (!hullSource)
+            ExtractClipHull(brush, faces);
+        else if (hullNums[i] != -1)
+            CopyClipHull(*hullSource, hullNums[i]);
+    }
+
+    m_SourceClipHullCount += m_ClipHulls.Size() - entityGeom.FirstClipHull;
+
+    if (settings.MergeClipHulls)
+        MergeClipHulls(entityGeom.FirstClipHull, settings.HullMergeTolerance);
+
+    std::sort(faceInfos.begin(), faceInfos.end(), [](FaceInfo const& a, FaceInfo const& b) { return a.Material < b.Material; });
+
+    ExtractSurfaces(faceInfos, faces);
+
+    entityGeom.SurfaceCount = m_Surfaces.Size() - entityGeom.FirstSurface;
+    entityGeom.ClipHullCount = m_ClipHulls.Size() - entityGeom.FirstClipHull;
+
+    entityGeom.Bounds.Clear();
+    for (int surfaceNum = 0; surfaceNum < entityGeom.SurfaceCount; ++surfaceNum)
+    {
+        auto& surface = m_Surfaces[entityGeom.FirstSurface + surfaceNum];
+        for (int v = 0; v < surface.VertexCount; ++v)
+            entityGeom.Bounds.AddPoint(m_Vertices[surface.FirstVert + v].Position);
+    }
+    for (int hullNum = 0; hullNum < entityGeom.ClipHullCount; ++hullNum)
+    {
+        auto& hull = m_ClipHulls[entityGeom.FirstClipHull + hullNum];
+        for (int v = 0; v < hull.VertexCount; ++v)
+            entityGeom.Bounds.AddPoint(m_ClipVertices[hull.FirstVert + v]);
     }
 }
 
@@ -229,6 +366,7 @@ void ConvexHullVerticesFromPlanes2(PlaneF const* planes, int planeCount, Vector<
     }
 }
 #endif
+
 void MapGeometry::ExtractClipHull(MapParser::Brush const& brush, Vector<MapParser::BrushFace> const& faces)
 {
     SmallVector<PlaneF, 32> clipPlanes;
@@ -260,6 +398,668 @@ void MapGeometry::ExtractClipHull(MapParser::Brush const& brush, Vector<MapParse
     clipHull.VertexCount = clipVertCount;
     clipHull.FirstIndex = firstClipIndex;
     clipHull.IndexCount = m_ClipIndices.Size() - firstClipIndex;
+    clipHull.FirstPlane = m_ClipPlanes.Size();
+    clipHull.PlaneCount = clipPlanes.Size();
+
+    for (PlaneF const& plane : clipPlanes)
+        m_ClipPlanes.Add(plane);
+}
+
+void MapGeometry::CopyClipHull(MapGeometry const& source, int hullNum)
+{
+    auto& sourceHull = source.m_ClipHulls[hullNum];
+
+    auto& clipHull = m_ClipHulls.EmplaceBack();
+    clipHull.FirstVert = m_ClipVertices.Size();
+    clipHull.VertexCount = sourceHull.VertexCount;
+    clipHull.FirstIndex = m_ClipIndices.Size();
+    clipHull.IndexCount = sourceHull.IndexCount;
+    clipHull.FirstPlane = m_ClipPlanes.Size();
+    clipHull.PlaneCount = sourceHull.PlaneCount;
+
+    // Indices are relative to the first vertex of the hull
+    for (int i = 0; i < sourceHull.VertexCount; ++i)
+        m_ClipVertices.Add(source.m_ClipVertices[sourceHull.FirstVert + i]);
+    for (int i = 0; i < sourceHull.IndexCount; ++i)
+        m_ClipIndices.Add(source.m_ClipIndices[sourceHull.FirstIndex + i]);
+    for (int i = 0; i < sourceHull.PlaneCount; ++i)
+        m_ClipPlanes.Add(source.m_ClipPlanes[sourceHull.FirstPlane + i]);
+}
+
+namespace
+{
+
+constexpr float ClipPlaneEpsilon = 0.001f;
+
+struct MergeHull
+{
+    Vector<PlaneF>      Planes;
+    Vector<Float3>      Vertices;
+    Vector<uint32_t>    Indices;
+    BvAxisAlignedBox    Bounds;
+    float               Volume;
+};
+
+HK_FORCEINLINE float PlaneDistance(PlaneF const& plane, Float3 const& point)
+{
+    return Math::Dot(plane.Normal, point) + plane.D;
+}
+
+bool IsBehindPlane(PlaneF const& plane, Vector<Float3> const& points)
+{
+    for (Float3 const& point : points)
+        if (PlaneDistance(plane, point) > ClipPlaneEpsilon)
+            return false;
+    return true;
+}
+
+// Checks that the points lie in front of the plane and at least one of them touches it
+bool IsTouchingPlaneFromFront(PlaneF const& plane, Vector<Float3> const& points)
+{
+    bool touching = false;
+    for (Float3 const& point : points)
+    {
+        float d = PlaneDistance(plane, point);
+        if (d < -ClipPlaneEpsilon)
+            return false;
+        if (d <= ClipPlaneEpsilon)
+            touching = true;
+    }
+    return touching;
+}
+
+bool HasPlane(Vector<PlaneF> const& planes, PlaneF const& plane)
+{
+    for (PlaneF const& p : planes)
+    {
+        if (Math::Dot(p.Normal, plane.Normal) > 0.9999f && Math::Abs(p.D - plane.D) < ClipPlaneEpsilon)
+            return true;
+    }
+    return false;
+}
+
+float CalcHullVolume(Vector<Float3> const& vertices, Vector<uint32_t> const& indices)
+{
+    if (vertices.IsEmpty())
+        return 0;
+
+    // Sum of signed tetrahedron volumes relative to the first vertex
+    Float3 const& origin = vertices[0];
+    float volume = 0;
+    for (int i = 0; i + 2 < indices.Size(); i += 3)
+    {
+        Float3 a = vertices[indices[i]] - origin;
+        Float3 b = vertices[indices[i + 1]] - origin;
+        Float3 c = vertices[indices[i + 2]] - origin;
+        volume += Math::Dot(a, Math::Cross(b, c));
+    }
+    return Math::Abs(volume) / 6.0f;
+}
+
+void CalcHullBounds(MergeHull& hull)
+{
+    hull.Bounds.Clear();
+    for (Float3 const& v : hull.Vertices)
+        hull.Bounds.AddPoint(v);
+}
+
+bool IsBoundsTouching(BvAxisAlignedBox const& a, BvAxisAlignedBox const& b)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        if (a.Mins[i] > b.Maxs[i] + ClipPlaneEpsilon || b.Mins[i] > a.Maxs[i] + ClipPlaneEpsilon)
+            return false;
+    }
+    return true;
+}
+
+bool TryMergeHulls(MergeHull const& a, MergeHull const& b, float tolerance, MergeHull& merged)
+{
+    if (!IsBoundsTouching(a.Bounds, b.Bounds))
+        return false;
+
+    // The hulls must be adjacent: one of them has a face plane that separates it from the other one.
+    // Then the volume of the union is exactly the sum of the volumes.
+    bool adjacent = false;
+    for (PlaneF const& plane : a.Planes)
+    {
+        if (IsTouchingPlaneFromFront(plane, b.Vertices))
+        {
+            adjacent = true;
+            break;
+        }
+    }
+    if (!adjacent)
+        return false;
+
+    // Keep the planes that bound both hulls. Their intersection contains the union of the hulls.
+    merged.Planes.Clear();
+    for (PlaneF const& plane : a.Planes)
+    {
+        if (IsBehindPlane(plane, b.Vertices) && !HasPlane(merged.Planes, plane))
+            merged.Planes.Add(plane);
+    }
+    for (PlaneF const& plane : b.Planes)
+    {
+        if (IsBehindPlane(plane, a.Vertices) && !HasPlane(merged.Planes, plane))
+            merged.Planes.Add(plane);
+    }
+
+    if (merged.Planes.Size() < 4)
+        return false;
+
+    merged.Vertices.Clear();
+    merged.Indices.Clear();
+    ConvexHullVerticesFromPlanes2(merged.Planes.ToPtr(), merged.Planes.Size(), merged.Vertices, merged.Indices);
+
+    if (merged.Vertices.Size() < 4)
+        return false;
+
+    // The union is convex only if the intersection doesn't add any volume
+    float sourceVolume = a.Volume + b.Volume;
+    merged.Volume = CalcHullVolume(merged.Vertices, merged.Indices);
+    if (Math::Abs(merged.Volume - sourceVolume) > tolerance * sourceVolume)
+        return false;
+
+    CalcHullBounds(merged);
+    return true;
+}
+
+// Uniform grid over the hull bounds. Limits merge candidates to the hulls that share a cell.
+class HullGrid
+{
+public:
+    void Build(Vector<MergeHull> const& hulls)
+    {
+        m_HullCount = hulls.Size();
+
+        BvAxisAlignedBox bounds;
+        bounds.Clear();
+        float extent = 0;
+        for (MergeHull const& hull : hulls)
+        {
+            bounds.AddAABB(hull.Bounds);
+
+            Float3 size = hull.Bounds.Size();
+            extent += Math::Max(Math::Max(size.X, size.Y), size.Z);
+        }
+
+        // Cells about the size of an average hull, but not too many of them
+        Float3 size = bounds.Size();
+        float cellSize = Math::Max(extent / hulls.Size(), Math::Max(Math::Max(size.X, size.Y), size.Z) / MaxCellsPerAxis);
+        if (cellSize <= 0)
+            cellSize = 1;
+
+        m_Origin = bounds.Mins;
+        m_InvCellSize = 1.0f / cellSize;
+        for (int i = 0; i < 3; ++i)
+            m_CellCount[i] = Math::Min(int(size[i] * m_InvCellSize) + 1, MaxCellsPerAxis);
+
+        m_Entries.Clear();
+        m_LargeHulls.Clear();
+
+        int mins[3], maxs[3];
+        for (int hullNum = 0; hullNum < hulls.Size(); ++hullNum)
+        {
+            // Hulls that span many cells are tested against everything instead
+            if (GetCellRange(hulls[hullNum].Bounds, mins, maxs) > MaxCellsPerHull)
+            {
+                m_LargeHulls.Add(hullNum);
+                continue;
+            }
+
+            for (int x = mins[0]; x <= maxs[0]; ++x)
+                for (int y = mins[1]; y <= maxs[1]; ++y)
+                    for (int z = mins[2]; z <= maxs[2]; ++z)
+                        m_Entries.Add({CellKey(x, y, z), hullNum});
+        }
+
+        std::sort(m_Entries.begin(), m_Entries.end(), [](Entry const& a, Entry const& b) { return a.Cell < b.Cell || (a.Cell == b.Cell && a.Hull < b.Hull); });
+    }
+
+    // Calls the visitor for every source hull that may touch the bounds. A hull may be visited more than once.
+    template <typename Visitor>
+    void Query(BvAxisAlignedBox const& bounds, Visitor const& visitor) const
+    {
+        int mins[3], maxs[3];
+        if (GetCellRange(bounds, mins, maxs) > m_Entries.Size())
+        {
+            // Walking the cells is slower than visiting all hulls
+            for (int hullNum = 0; hullNum < m_HullCount; ++hullNum)
+                visitor(hullNum);
+            return;
+        }
+
+        for (int hullNum : m_LargeHulls)
+            visitor(hullNum);
+
+        for (int x = mins[0]; x <= maxs[0]; ++x)
+            for (int y = mins[1]; y <= maxs[1]; ++y)
+                for (int z = mins[2]; z <= maxs[2]; ++z)
+                {
+                    uint64_t key = CellKey(x, y, z);
+                    auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), key, [](Entry const& entry, uint64_t key) { return entry.Cell < key; });
+                    for (; it != m_Entries.end() && it->Cell == key; ++it)
+                        visitor(it->Hull);
+                }
+    }
+
+private:
+    static constexpr int MaxCellsPerAxis = 1024;
+    static constexpr int MaxCellsPerHull = 64;
+
+    struct Entry
+    {
+        uint64_t    Cell;
+        int         Hull;
+    };
+
+    static uint64_t CellKey(int x, int y, int z)
+    {
+        return (uint64_t(x) << 42) | (uint64_t(y) << 21) | uint64_t(z);
+    }
+
+    // Returns the number of cells touched by the bounds
+    int64_t GetCellRange(BvAxisAlignedBox const& bounds, int mins[3], int maxs[3]) const
+    {
+        int64_t count = 1;
+        for (int i = 0; i < 3; ++i)
+        {
+            mins[i] = Math::Max(int(Math::Floor((bounds.Mins[i] - ClipPlaneEpsilon - m_Origin[i]) * m_InvCellSize)), 0);
+            maxs[i] = Math::Min(int(Math::Floor((bounds.Maxs[i] + ClipPlaneEpsilon - m_Origin[i]) * m_InvCellSize)), m_CellCount[i] - 1);
+            count *= Math::Max(maxs[i] - mins[i] + 1, 0);
+        }
+        return count;
+    }
+
+    Vector<Entry>       m_Entries;
+    Vector<int>         m_LargeHulls;
+    Float3              m_Origin;
+    float               m_InvCellSize = 1;
+    int                 m_CellCount[3] = {};
+    int                 m_HullCount = 0;
+};
+
+}
+
+void MapGeometry::MergeClipHulls(int firstClipHull, float tolerance)
+{
+    int hullCount = m_ClipHulls.Size() - firstClipHull;
+    if (hullCount < 2)
+        return;
+
+    Vector<MergeHull> hulls;
+    hulls.Reserve(hullCount);
+
+    for (int hullNum = firstClipHull; hullNum < m_ClipHulls.Size(); ++hullNum)
+    {
+        auto& clipHull = m_ClipHulls[hullNum];
+        auto& hull = hulls.EmplaceBack();
+
+        hull.Planes.Reserve(clipHull.PlaneCount);
+        for (int i = 0; i < clipHull.PlaneCount; ++i)
+            hull.Planes.Add(m_ClipPlanes[clipHull.FirstPlane + i]);
+
+        hull.Vertices.Reserve(clipHull.VertexCount);
+        for (int i = 0; i < clipHull.VertexCount; ++i)
+            hull.Vertices.Add(m_ClipVertices[clipHull.FirstVert + i]);
+
+        hull.Indices.Reserve(clipHull.IndexCount);
+        for (int i = 0; i < clipHull.IndexCount; ++i)
+            hull.Indices.Add(m_ClipIndices[clipHull.FirstIndex + i]);
+
+        hull.Volume = CalcHullVolume(hull.Vertices, hull.Indices);
+        CalcHullBounds(hull);
+    }
+
+    HullGrid grid;
+    grid.Build(hulls);
+
+    // Hull that absorbed the source hull. The grid keeps the source hulls, so absorbed ones are redirected to the owner.
+    Vector<int> owner;
+    owner.Resize(hullCount);
+    for (int i = 0; i < hullCount; ++i)
+        owner[i] = i;
+
+    auto findOwner = [&owner](int hullNum)
+    {
+        while (owner[hullNum] != hullNum)
+        {
+            owner[hullNum] = owner[owner[hullNum]];
+            hullNum = owner[hullNum];
+        }
+        return hullNum;
+    };
+
+    // Stamp of the last query that queued the hull
+    Vector<int> queryStamp;
+    queryStamp.Resize(hullCount);
+    for (int i = 0; i < hullCount; ++i)
+        queryStamp[i] = -1;
+
+    // Greedy pass: grow each hull by absorbing its neighbors until nothing can be merged
+    Vector<int> candidates;
+    MergeHull merged;
+    int stamp = 0;
+    int mergeCount = 0;
+    for (int i = 0; i < hullCount; ++i)
+    {
+        if (owner[i] != i)
+            continue;
+
+        for (bool grown = true; grown;)
+        {
+            grown = false;
+
+            // Only the neighbors of the current hull can be merged with it
+            candidates.Clear();
+            grid.Query(hulls[i].Bounds, [&](int hullNum)
+            {
+                hullNum = findOwner(hullNum);
+                if (hullNum != i && queryStamp[hullNum] != stamp && IsBoundsTouching(hulls[i].Bounds, hulls[hullNum].Bounds))
+                {
+                    queryStamp[hullNum] = stamp;
+                    candidates.Add(hullNum);
+                }
+            });
+            ++stamp;
+
+            for (int j : candidates)
+            {
+                if (TryMergeHulls(hulls[i], hulls[j], tolerance, merged))
+                {
+                    std::swap(hulls[i], merged);
+                    owner[j] = i;
+                    ++mergeCount;
+
+                    // The hull has grown, so its neighbors are queried again
+                    grown = true;
+                }
+            }
+        }
+    }
+
+    if (!mergeCount)
+        return;
+
+    auto& first = m_ClipHulls[firstClipHull];
+    m_ClipVertices.Resize(first.FirstVert);
+    m_ClipIndices.Resize(first.FirstIndex);
+    m_ClipPlanes.Resize(first.FirstPlane);
+    m_ClipHulls.Resize(firstClipHull);
+
+    // Compact the hulls that were not absorbed
+    for (int hullNum = 0; hullNum < hullCount; ++hullNum)
+    {
+        if (owner[hullNum] != hullNum)
+            continue;
+
+        MergeHull const& hull = hulls[hullNum];
+        auto& clipHull = m_ClipHulls.EmplaceBack();
+        clipHull.FirstVert = m_ClipVertices.Size();
+        clipHull.VertexCount = hull.Vertices.Size();
+        clipHull.FirstIndex = m_ClipIndices.Size();
+        clipHull.IndexCount = hull.Indices.Size();
+        clipHull.FirstPlane = m_ClipPlanes.Size();
+        clipHull.PlaneCount = hull.Planes.Size();
+
+        for (Float3 const& v : hull.Vertices)
+            m_ClipVertices.Add(v);
+        for (uint32_t index : hull.Indices)
+            m_ClipIndices.Add(index);
+        for (PlaneF const& plane : hull.Planes)
+            m_ClipPlanes.Add(plane);
+    }
+}
+
+namespace
+{
+
+HK_FORCEINLINE uint64_t HashValue(uint64_t hash, uint64_t value)
+{
+    // FNV-1a step
+    hash ^= value;
+    hash *= 0x100000001b3ull;
+    return hash;
+}
+
+// Positions that differ by less than the cell size usually fall into the same cell. Positions near a cell
+// border may not, which only costs a missed instance.
+HK_FORCEINLINE uint64_t HashPosition(uint64_t hash, Float3 const& position, float invCellSize)
+{
+    hash = HashValue(hash, uint32_t(int32_t(Math::Floor(position.X * invCellSize + 0.5f))));
+    hash = HashValue(hash, uint32_t(int32_t(Math::Floor(position.Y * invCellSize + 0.5f))));
+    hash = HashValue(hash, uint32_t(int32_t(Math::Floor(position.Z * invCellSize + 0.5f))));
+    return hash;
+}
+
+HK_FORCEINLINE bool IsInteger(float value, float epsilon)
+{
+    return Math::Abs(value - Math::Floor(value + 0.5f)) <= epsilon;
+}
+
+}
+
+void MapGeometry::MoveToLocalSpace(Entity& entity)
+{
+    entity.Origin = entity.Bounds.Mins;
+
+    for (int surfaceNum = 0; surfaceNum < entity.SurfaceCount; ++surfaceNum)
+    {
+        auto& surface = m_Surfaces[entity.FirstSurface + surfaceNum];
+        for (int v = 0; v < surface.VertexCount; ++v)
+            m_Vertices[surface.FirstVert + v].Position -= entity.Origin;
+    }
+
+    for (int hullNum = 0; hullNum < entity.ClipHullCount; ++hullNum)
+    {
+        auto& hull = m_ClipHulls[entity.FirstClipHull + hullNum];
+        for (int v = 0; v < hull.VertexCount; ++v)
+            m_ClipVertices[hull.FirstVert + v] -= entity.Origin;
+        for (int p = 0; p < hull.PlaneCount; ++p)
+        {
+            auto& plane = m_ClipPlanes[hull.FirstPlane + p];
+            plane.D += Math::Dot(plane.Normal, entity.Origin);
+        }
+    }
+}
+
+bool MapGeometry::IsSameGeometry(Entity const& a, Entity const& b, float tolerance) const
+{
+    if (a.SurfaceCount != b.SurfaceCount || a.ClipHullCount != b.ClipHullCount)
+        return false;
+
+    for (int surfaceNum = 0; surfaceNum < a.SurfaceCount; ++surfaceNum)
+    {
+        auto& surfaceA = m_Surfaces[a.FirstSurface + surfaceNum];
+        auto& surfaceB = m_Surfaces[b.FirstSurface + surfaceNum];
+
+        if (surfaceA.Material != surfaceB.Material || surfaceA.VertexCount != surfaceB.VertexCount || surfaceA.IndexCount != surfaceB.IndexCount)
+            return false;
+
+        for (int i = 0; i < surfaceA.IndexCount; ++i)
+            if (m_Indices[surfaceA.FirstIndex + i] != m_Indices[surfaceB.FirstIndex + i])
+                return false;
+
+        MeshVertex const* verticesA = &m_Vertices[surfaceA.FirstVert];
+        MeshVertex const* verticesB = &m_Vertices[surfaceB.FirstVert];
+
+        // Texture coordinates may differ only by a whole number of texture repeats
+        Float2 texCoordShift = verticesB[0].GetTexCoord() - verticesA[0].GetTexCoord();
+        if (!IsInteger(texCoordShift.X, 0.001f) || !IsInteger(texCoordShift.Y, 0.001f))
+            return false;
+
+        for (int v = 0; v < surfaceA.VertexCount; ++v)
+        {
+            if (!verticesA[v].Position.CompareEps(verticesB[v].Position, tolerance))
+                return false;
+            if (!(verticesB[v].GetTexCoord() - verticesA[v].GetTexCoord()).CompareEps(texCoordShift, 0.001f))
+                return false;
+        }
+    }
+
+    for (int hullNum = 0; hullNum < a.ClipHullCount; ++hullNum)
+    {
+        auto& hullA = m_ClipHulls[a.FirstClipHull + hullNum];
+        auto& hullB = m_ClipHulls[b.FirstClipHull + hullNum];
+
+        if (hullA.VertexCount != hullB.VertexCount || hullA.IndexCount != hullB.IndexCount)
+            return false;
+
+        for (int v = 0; v < hullA.VertexCount; ++v)
+            if (!m_ClipVertices[hullA.FirstVert + v].CompareEps(m_ClipVertices[hullB.FirstVert + v], tolerance))
+                return false;
+
+        for (int i = 0; i < hullA.IndexCount; ++i)
+            if (m_ClipIndices[hullA.FirstIndex + i] != m_ClipIndices[hullB.FirstIndex + i])
+                return false;
+    }
+
+    return true;
+}
+
+void MapGeometry::InstanceEntities(float tolerance)
+{
+    struct EntityKey
+    {
+        uint64_t    Hash;
+        int         EntityNum;
+    };
+
+    Vector<EntityKey> keys;
+    keys.Reserve(m_Entities.Size());
+
+    float invCellSize = 1.0f / Math::Max(tolerance, 0.0001f);
+
+    for (int entityNum = 0; entityNum < m_Entities.Size(); ++entityNum)
+    {
+        auto& entity = m_Entities[entityNum];
+        if (entity.SurfaceCount == 0 && entity.ClipHullCount == 0)
+            continue;
+
+        MoveToLocalSpace(entity);
+
+        // Hash the local space positions quantized to the tolerance, so entities of the same topology but
+        // different size get different hashes. IsSameGeometry confirms the match later.
+        uint64_t hash = 0xcbf29ce484222325ull;
+        hash = HashValue(hash, entity.SurfaceCount);
+        hash = HashValue(hash, entity.ClipHullCount);
+        for (int surfaceNum = 0; surfaceNum < entity.SurfaceCount; ++surfaceNum)
+        {
+            auto& surface = m_Surfaces[entity.FirstSurface + surfaceNum];
+            hash = HashValue(hash, surface.Material);
+            hash = HashValue(hash, surface.VertexCount);
+            hash = HashValue(hash, surface.IndexCount);
+            for (int v = 0; v < surface.VertexCount; ++v)
+                hash = HashPosition(hash, m_Vertices[surface.FirstVert + v].Position, invCellSize);
+        }
+        for (int hullNum = 0; hullNum < entity.ClipHullCount; ++hullNum)
+        {
+            auto& hull = m_ClipHulls[entity.FirstClipHull + hullNum];
+            hash = HashValue(hash, hull.VertexCount);
+            hash = HashValue(hash, hull.IndexCount);
+            for (int v = 0; v < hull.VertexCount; ++v)
+                hash = HashPosition(hash, m_ClipVertices[hull.FirstVert + v], invCellSize);
+        }
+
+        keys.Add({hash, entityNum});
+    }
+
+    std::sort(keys.begin(), keys.end(), [](EntityKey const& a, EntityKey const& b) { return a.Hash < b.Hash || (a.Hash == b.Hash && a.EntityNum < b.EntityNum); });
+
+    // Within a run of equal hashes the prototype always has the smallest entity index
+    int instanceCount = 0;
+    for (int first = 0; first < keys.Size();)
+    {
+        int last = first + 1;
+        while (last < keys.Size() && keys[last].Hash == keys[first].Hash)
+            ++last;
+
+        for (int i = first + 1; i < last; ++i)
+        {
+            auto& entity = m_Entities[keys[i].EntityNum];
+            for (int j = first; j < i; ++j)
+            {
+                auto& candidate = m_Entities[keys[j].EntityNum];
+                if (candidate.Prototype == keys[j].EntityNum && IsSameGeometry(candidate, entity, tolerance))
+                {
+                    entity.Prototype = keys[j].EntityNum;
+                    ++instanceCount;
+                    break;
+                }
+            }
+        }
+
+        first = last;
+    }
+
+    LOG("MapGeometry::Build: {} entities share geometry with other entities\n", instanceCount);
+
+    if (!instanceCount)
+        return;
+
+    // Drop the geometry of instances
+    Vector<Surface> surfaces;
+    Vector<MeshVertex> vertices;
+    Vector<uint32_t> indices;
+    Vector<Float3> clipVertices;
+    Vector<uint32_t> clipIndices;
+    Vector<ClipHull> clipHulls;
+    Vector<PlaneF> clipPlanes;
+
+    for (int entityNum = 0; entityNum < m_Entities.Size(); ++entityNum)
+    {
+        auto& entity = m_Entities[entityNum];
+        if (entity.Prototype != entityNum)
+        {
+            auto& prototype = m_Entities[entity.Prototype];
+            entity.FirstSurface = prototype.FirstSurface;
+            entity.FirstClipHull = prototype.FirstClipHull;
+            continue;
+        }
+
+        int firstSurface = surfaces.Size();
+        for (int surfaceNum = 0; surfaceNum < entity.SurfaceCount; ++surfaceNum)
+        {
+            auto& surface = surfaces.EmplaceBack(m_Surfaces[entity.FirstSurface + surfaceNum]);
+            int firstVert = vertices.Size();
+            int firstIndex = indices.Size();
+            for (int v = 0; v < surface.VertexCount; ++v)
+                vertices.Add(m_Vertices[surface.FirstVert + v]);
+            for (int i = 0; i < surface.IndexCount; ++i)
+                indices.Add(m_Indices[surface.FirstIndex + i]);
+            surface.FirstVert = firstVert;
+            surface.FirstIndex = firstIndex;
+        }
+        entity.FirstSurface = firstSurface;
+
+        int firstClipHull = clipHulls.Size();
+        for (int hullNum = 0; hullNum < entity.ClipHullCount; ++hullNum)
+        {
+            auto& hull = clipHulls.EmplaceBack(m_ClipHulls[entity.FirstClipHull + hullNum]);
+            int firstVert = clipVertices.Size();
+            int firstIndex = clipIndices.Size();
+            int firstPlane = clipPlanes.Size();
+            for (int v = 0; v < hull.VertexCount; ++v)
+                clipVertices.Add(m_ClipVertices[hull.FirstVert + v]);
+            for (int i = 0; i < hull.IndexCount; ++i)
+                clipIndices.Add(m_ClipIndices[hull.FirstIndex + i]);
+            for (int p = 0; p < hull.PlaneCount; ++p)
+                clipPlanes.Add(m_ClipPlanes[hull.FirstPlane + p]);
+            hull.FirstVert = firstVert;
+            hull.FirstIndex = firstIndex;
+            hull.FirstPlane = firstPlane;
+        }
+        entity.FirstClipHull = firstClipHull;
+    }
+
+    m_Surfaces = std::move(surfaces);
+    m_Vertices = std::move(vertices);
+    m_Indices = std::move(indices);
+    m_ClipVertices = std::move(clipVertices);
+    m_ClipIndices = std::move(clipIndices);
+    m_ClipHulls = std::move(clipHulls);
+    m_ClipPlanes = std::move(clipPlanes);
 }
 
 HK_NAMESPACE_END
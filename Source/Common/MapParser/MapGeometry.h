@@ -31,11 +31,33 @@ SOFTWARE.
 #pragma once
 
 #include "MapParser.h"
+#include "../MemoryTags.h"
 
 #include <Hork/Geometry/VertexFormat.h>
+#include <Hork/Geometry/BV/BvAxisAlignedBox.h>
 
 HK_NAMESPACE_BEGIN
 
+struct MapGeometrySettings
+{
+    // Greedily merge adjacent clip hulls of an entity when their union is convex.
+    // Fewer hulls means fewer narrowphase pairs, e.g. on tiled floors.
+    bool                MergeClipHulls = true;
+
+    // Allowed relative difference between the merged hull volume and the sum of the source volumes
+    float               HullMergeTolerance = 0.001f;
+
+    // Share geometry between entities that differ only by translation
+    bool                InstanceEntities = true;
+
+    // Max distance between matching vertices of instanced entities
+    float               InstanceTolerance = 0.001f;
+
+    // Split worldspawn brushes into clusters by a horizontal grid with cells of this size.
+    // Zero disables clustering.
+    float               ClusterSize = 0;
+};
+
 class MapGeometry
 {
 public:
@@ -54,6 +76,8 @@ public:
         int             VertexCount;
         int             FirstIndex;
         int             IndexCount;
+        int             FirstPlane;
+        int             PlaneCount;
     };
 
     struct Entity
@@ -63,9 +87,24 @@ public:
 
         int             FirstClipHull;
         int             ClipHullCount;
+
+        // Entity geometry is stored relative to this point
+        Float3          Origin;
+
+        // Index of the entity that owns the geometry. Equals the entity index if the geometry is unique.
+        int             Prototype;
+
+        // Index of the parser entity. With clustering one parser entity may produce several entities.
+        int             SourceEntity;
+
+        // World space bounds
+        BvAxisAlignedBox Bounds;
     };
 
-    void                Build(MapParser const& parser);
+    void                Build(MapParser const& parser, MapGeometrySettings const& settings = {});
+
+    // Adds the memory of the geometry to the report
+    void                SetMemoryReport(MemoryReport* report) { m_Memory.SetReport(report); }
 
     Vector<Surface> const&     GetSurfaces() const { return m_Surfaces; }
     Vector<MeshVertex> const&  GetVertices() const { return m_Vertices; }
@@ -73,8 +112,15 @@ public:
     Vector<Float3> const&      GetClipVertices() const { return m_ClipVertices; }
     Vector<uint32_t> const&    GetClipIndices() const { return m_ClipIndices; }
     Vector<ClipHull> const&    GetClipHulls() const { return m_ClipHulls; }
+    Vector<PlaneF> const&      GetClipPlanes() const { return m_ClipPlanes; }
     Vector<Entity> const&      GetEntities() const { return m_Entities; }
 
+    // Number of clip hulls extracted from brushes before merging
+    int                        GetSourceClipHullCount() const { return m_SourceClipHullCount; }
+
+    // Number of clip hulls after merging, before instanced entities drop theirs
+    int                        GetMergedClipHullCount() const { return m_MergedClipHullCount; }
+
 private:
     struct FaceInfo
     {
@@ -83,8 +129,16 @@ private:
         MapParser::Brush const* Brush;
     };
 
+    // With hullSource, clip hulls are copied from it instead of being extracted. hullNums are parallel to brushNums, -1 for no hull.
+    void                BuildEntity(int sourceEntity, int const* brushNums, int brushCount, MapParser const& parser, MapGeometrySettings const& settings, MapGeometry const* hullSource = nullptr, int const* hullNums = nullptr);
     void                ExtractSurfaces(Vector<FaceInfo> const& faceInfos, Vector<MapParser::BrushFace> const& faces);
     void                ExtractClipHull(MapParser::Brush const& brush, Vector<MapParser::BrushFace> const& faces);
+    void                CopyClipHull(MapGeometry const& source, int hullNum);
+    void                MergeClipHulls(int firstClipHull, float tolerance);
+    void                InstanceEntities(float tolerance);
+    void                MoveToLocalSpace(Entity& entity);
+    bool                IsSameGeometry(Entity const& a, Entity const& b, float tolerance) const;
+    void                UpdateMemory();
 
     Vector<Surface>     m_Surfaces;
     Vector<MeshVertex>  m_Vertices;
@@ -92,7 +146,11 @@ private:
     Vector<Float3>      m_ClipVertices;
     Vector<uint32_t>    m_ClipIndices;
     Vector<ClipHull>    m_ClipHulls;
+    Vector<PlaneF>      m_ClipPlanes;
     Vector<Entity>      m_Entities;
+    int                 m_SourceClipHullCount = 0;
+    int                 m_MergedClipHullCount = 0;
+    TaggedMemory        m_Memory{MemoryTag::MapGeometry};
 };
 
 HK_NAMESPACE_END
@@ -31,6 +31,7 @@ SOFTWARE.
 #include "MapParser.h"
 
 #include "../Lexer/Lexer.h"
+#include "../TraceProfiler.h"
 #include <Hork/Core/Parse.h>
 
 HK_NAMESPACE_BEGIN
@@ -165,6 +166,8 @@ uint32_t AddMaterial(const char* name, Vector<MapParser::Material>& materials)
 
 void MapParser::Parse(const char* buffer)
 {
+    HK_TRACE_ZONE("MapParser::Parse");
+
     Lexer lex;
 
     lex.SetName("Map");
@@ -186,8 +189,23 @@ void MapParser::Parse(const char* buffer)
         if (*token == '{')
         {
             ParseEntity(m_Entities.EmplaceBack(), lex);
+
+            // Updated per entity, so the peak covers the containers while they grow
+            UpdateMemory();
         }
     }
+
+    UpdateMemory();
+}
+
+void MapParser::UpdateMemory()
+{
+    m_Memory.Set(GetContainerBytes(m_Entities) +
+                 GetContainerBytes(m_Brushes) +
+                 GetContainerBytes(m_Faces) +
+                 GetContainerBytes(m_Patches) +
+                 GetContainerBytes(m_PatchVertices) +
+                 GetContainerBytes(m_Materials));
 }
 
 void MapParser::ParseEntity(Entity& entity, Lexer& lex)
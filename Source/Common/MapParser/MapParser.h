@@ -33,6 +33,8 @@ SOFTWARE.
 #include <Hork/Math/Plane.h>
 #include <Hork/Core/Containers/Vector.h>
 
+#include "../MemoryTags.h"
+
 HK_NAMESPACE_BEGIN
 
 class Lexer;
@@ -94,6 +96,9 @@ public:
 
     void                    Parse(const char* buffer);
 
+    // Adds the memory of the parsed data to the report
+    void                    SetMemoryReport(MemoryReport* report) { m_Memory.SetReport(report); }
+
     int                     FindEntity(const char* className) const;
 
     Vector<Entity> const&       GetEntities() const { return m_Entities; }
@@ -108,6 +113,7 @@ private:
     void                    ParseBlock(Entity& entity, Lexer& lex);
     bool                    ParseBrush(Brush& brush, Lexer& lex);
     bool                    ParsePatch(Patch& patch, Lexer& lex);
+    void                    UpdateMemory();
 
     Vector<Entity>          m_Entities;
     Vector<Brush>           m_Brushes;
@@ -115,6 +121,7 @@ private:
     Vector<Patch>           m_Patches;
     Vector<PatchVertex>     m_PatchVertices;
     Vector<Material>        m_Materials;
+    TaggedMemory            m_Memory{MemoryTag::MapParser};
 };
 
 
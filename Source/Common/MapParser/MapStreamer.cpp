@@ -0,0 +1,495 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "MapStreamer.h"
+#include "Utils.h"
+#include "../TraceProfiler.h"
+#include "../Interfaces/DestructionInterface.h"
+
+#include <Hork/Core/Logger.h>
+#include <Hork/GameApplication/GameApplication.h>
+
+#include <chrono>
+
+HK_NAMESPACE_BEGIN
+
+MapStreamer::~MapStreamer()
+{
+    // The world may be destroyed already, so sector objects are left to it
+    HK_ASSERT(!m_World);
+    m_World = nullptr;
+
+    Deinitialize();
+}
+
+void MapStreamer::Initialize(World* world, MapGeometry&& geometry, StringView name, StringView defaultMaterial)
+{
+    Release();
+
+    m_World = world;
+    m_Geometry = std::move(geometry);
+    m_Name = name;
+    m_DefaultMaterial = defaultMaterial;
+
+    int surfaceCount = m_Geometry.GetSurfaces().Size();
+    int hullCount = m_Geometry.GetClipHulls().Size();
+
+    m_SurfaceMeshes.Resize(surfaceCount);
+    m_SurfaceBounds.Resize(surfaceCount);
+    m_SurfaceRefs.Resize(surfaceCount);
+    m_SurfaceGeneration.Resize(surfaceCount);
+    m_ClipHullData.Resize(hullCount);
+    m_ClipHullRefs.Resize(hullCount);
+
+    for (int surfaceIndex = 0; surfaceIndex < surfaceCount; ++surfaceIndex)
+    {
+        m_SurfaceRefs[surfaceIndex] = 0;
+        m_SurfaceGeneration[surfaceIndex] = 0;
+    }
+    for (int hullIndex = 0; hullIndex < hullCount; ++hullIndex)
+        m_ClipHullRefs[hullIndex] = 0;
+
+    CreateSectors();
+
+    LOG("MapStreamer: {} sectors in {}\n", m_Sectors.Size(), m_Name);
+}
+
+void MapStreamer::LoadAsync(World* world, StringView mapFilename, StringView defaultMaterial)
+{
+    Release();
+
+    MapGeometrySettings settings;
+    settings.ClusterSize = SectorSize;
+
+    m_World = world;
+    m_DefaultMaterial = defaultMaterial;
+
+    m_Loader = MakeUnique<MapLoader>();
+    m_Loader->LoadAsync(mapFilename, settings, MapLoadMode::Streaming);
+}
+
+void MapStreamer::Deinitialize()
+{
+    Release();
+
+    m_Sources.Clear();
+    m_SourcePositions.Clear();
+    m_World = nullptr;
+}
+
+void MapStreamer::Release()
+{
+    // Waits for the map worker
+    m_Loader.Reset();
+
+    m_Requests.Clear();
+
+    for (int sectorIndex = 0; sectorIndex < m_Sectors.Size(); ++sectorIndex)
+    {
+        if (m_Sectors[sectorIndex].State == SectorState::Loaded)
+            UnloadSector(sectorIndex);
+    }
+
+    // The sectors are torn down in one batch now, their resources are released before the arrays are cleared
+    if (m_World)
+        m_World->GetInterface<DestructionInterface>().Flush();
+
+    m_Sectors.Clear();
+    m_SurfaceMeshes.Clear();
+    m_SurfaceBounds.Clear();
+    m_SurfaceRefs.Clear();
+    m_SurfaceGeneration.Clear();
+    m_ClipHullData.Clear();
+    m_ClipHullRefs.Clear();
+    m_Geometry = {};
+    m_LoadedSectorCount = 0;
+    m_LoadingSectorCount = 0;
+    m_ResidentMemory = 0;
+    m_PendingMemory = 0;
+}
+
+void MapStreamer::CreateSectors()
+{
+    auto& entities = m_Geometry.GetEntities();
+    auto& surfaces = m_Geometry.GetSurfaces();
+    auto& hulls = m_Geometry.GetClipHulls();
+
+    struct SectorEntity
+    {
+        int64_t     Cell;
+        int         EntityNum;
+    };
+
+    // Bucket entities by the grid cell of their center. Worldspawn clusters are built with the same grid.
+    Vector<SectorEntity> sectorEntities;
+    sectorEntities.Reserve(entities.Size());
+    for (int entityNum = 0; entityNum < entities.Size(); ++entityNum)
+    {
+        auto& entity = entities[entityNum];
+        if (entity.SurfaceCount == 0 && entity.ClipHullCount == 0)
+            continue;
+
+        Float3 center = entity.Bounds.Center();
+
+        int32_t x = int32_t(Math::Floor(center.X / SectorSize));
+        int32_t z = int32_t(Math::Floor(center.Z / SectorSize));
+
+        sectorEntities.Add({(int64_t(x) << 32) | uint32_t(z), entityNum});
+    }
+
+    std::sort(sectorEntities.begin(), sectorEntities.end(), [](SectorEntity const& a, SectorEntity const& b) { return a.Cell < b.Cell || (a.Cell == b.Cell && a.EntityNum < b.EntityNum); });
+
+    // Last sector that referenced the surface or hull
+    Vector<int> surfaceMarks;
+    Vector<int> hullMarks;
+    surfaceMarks.Resize(surfaces.Size());
+    hullMarks.Resize(hulls.Size());
+    for (int& mark : surfaceMarks)
+        mark = -1;
+    for (int& mark : hullMarks)
+        mark = -1;
+
+    for (int i = 0; i < sectorEntities.Size();)
+    {
+        int sectorIndex = m_Sectors.Size();
+        Sector& sector = m_Sectors.EmplaceBack();
+        sector.Bounds.Clear();
+
+        int64_t cell = sectorEntities[i].Cell;
+        for (; i < sectorEntities.Size() && sectorEntities[i].Cell == cell; ++i)
+        {
+            int entityNum = sectorEntities[i].EntityNum;
+            auto& entity = entities[entityNum];
+
+            sector.Entities.Add(entityNum);
+            sector.Bounds.AddAABB(entity.Bounds);
+
+            // Instanced entities share surfaces and hulls, count them once per sector
+            for (int surfaceNum = 0; surfaceNum < entity.SurfaceCount; ++surfaceNum)
+            {
+                int surfaceIndex = entity.FirstSurface + surfaceNum;
+                if (surfaceMarks[surfaceIndex] == sectorIndex)
+                    continue;
+                surfaceMarks[surfaceIndex] = sectorIndex;
+
+                sector.Surfaces.Add(surfaceIndex);
+                sector.Memory += surfaces[surfaceIndex].VertexCount * sizeof(MeshVertex) + surfaces[surfaceIndex].IndexCount * sizeof(uint32_t);
+            }
+
+            for (int hullNum = 0; hullNum < entity.ClipHullCount; ++hullNum)
+            {
+                int hullIndex = entity.FirstClipHull + hullNum;
+                if (hullMarks[hullIndex] == sectorIndex)
+                    continue;
+                hullMarks[hullIndex] = sectorIndex;
+
+                sector.ClipHulls.Add(hullIndex);
+                sector.Memory += hulls[hullIndex].VertexCount * sizeof(Float3);
+            }
+        }
+    }
+}
+
+void MapStreamer::AddSource(GameObjectHandle source)
+{
+    m_Sources.Add(source);
+}
+
+void MapStreamer::RemoveSource(GameObjectHandle source)
+{
+    for (int i = 0; i < m_Sources.Size(); ++i)
+    {
+        if (m_Sources[i] == source)
+        {
+            m_Sources.Remove(i);
+            return;
+        }
+    }
+}
+
+void MapStreamer::AddSourcePosition(Float3 const& position)
+{
+    m_SourcePositions.Add(position);
+}
+
+void MapStreamer::LoadSector(int sectorIndex)
+{
+    HK_TRACE_ZONE("MapStreamer::LoadSector");
+
+    auto& resourceMngr = GameApplication::sGetResourceManager();
+
+    Sector& sector = m_Sectors[sectorIndex];
+
+    for (int surfaceIndex : sector.Surfaces)
+    {
+        // Already resident through another sector
+        if (m_SurfaceRefs[surfaceIndex]++ > 0)
+            continue;
+
+        // Purged resources keep their names, so every reload gets a new one
+        String resourceName = m_Name + "/surface_" + Core::ToString(surfaceIndex) + "_" + Core::ToString(m_SurfaceGeneration[surfaceIndex]++);
+
+        UniqueRef<MeshResource> mesh = CreateMapSurfaceMesh(m_Geometry, surfaceIndex, m_SurfaceBounds[surfaceIndex]);
+        mesh->Upload();
+        resourceMngr.CreateResourceWithData(resourceName, std::move(mesh));
+
+        m_SurfaceMeshes[surfaceIndex] = resourceMngr.GetResource<MeshResource>(resourceName);
+    }
+
+    for (int hullIndex : sector.ClipHulls)
+    {
+        if (m_ClipHullRefs[hullIndex]++ == 0)
+            m_ClipHullData[hullIndex] = CreateMapClipHullData(m_Geometry, hullIndex);
+    }
+
+    auto& entities = m_Geometry.GetEntities();
+    for (int entityNum : sector.Entities)
+    {
+        GameObject* object = CreateMapEntity(m_World, entities[entityNum], m_SurfaceMeshes.ToPtr(), m_SurfaceBounds.ToPtr(), m_ClipHullData.ToPtr(), m_DefaultMaterial);
+        sector.Objects.Add(object->GetHandle());
+    }
+
+    sector.State = SectorState::Loaded;
+    m_LoadedSectorCount++;
+    m_LoadingSectorCount--;
+    m_PendingMemory -= sector.Memory;
+    m_ResidentMemory += sector.Memory;
+}
+
+void MapStreamer::UnloadSector(int sectorIndex)
+{
+    Sector& sector = m_Sectors[sectorIndex];
+    HK_ASSERT(sector.State == SectorState::Loaded);
+
+    // Collision objects are children of the entity objects and are destroyed with them.
+    // The objects are destroyed in one batch with the other sectors unloaded in this frame, the resources
+    // they use are released after that. Without the world the objects are gone already.
+    if (m_World)
+    {
+        auto& destruction = m_World->GetInterface<DestructionInterface>();
+        for (GameObjectHandle handle : sector.Objects)
+            destruction.Destroy(handle);
+        destruction.OnDestroyed([this, sectorIndex]() { ReleaseSectorResources(sectorIndex); });
+    }
+    else
+        ReleaseSectorResources(sectorIndex);
+    sector.Objects.Clear();
+
+    sector.State = SectorState::Unloaded;
+    m_LoadedSectorCount--;
+    m_ResidentMemory -= sector.Memory;
+}
+
+void MapStreamer::ReleaseSectorResources(int sectorIndex)
+{
+    auto& resourceMngr = GameApplication::sGetResourceManager();
+
+    Sector& sector = m_Sectors[sectorIndex];
+
+    // A sector loaded again before the release keeps the shared resources alive through its own references
+    for (int surfaceIndex : sector.Surfaces)
+    {
+        if (--m_SurfaceRefs[surfaceIndex] == 0)
+        {
+            resourceMngr.PurgeResourceData(m_SurfaceMeshes[surfaceIndex]);
+            m_SurfaceMeshes[surfaceIndex] = {};
+        }
+    }
+
+    for (int hullIndex : sector.ClipHulls)
+    {
+        if (--m_ClipHullRefs[hullIndex] == 0)
+            m_ClipHullData[hullIndex].Reset();
+    }
+}
+
+float MapStreamer::GetSourceDistance(Sector const& sector, Vector<Float3> const& sources) const
+{
+    float minDistSqr = -1;
+    for (Float3 const& position : sources)
+    {
+        Float3 d;
+        for (int axis = 0; axis < 3; ++axis)
+            d[axis] = Math::Max(Math::Max(sector.Bounds.Mins[axis] - position[axis], position[axis] - sector.Bounds.Maxs[axis]), 0.0f);
+
+        float distSqr = d.LengthSqr();
+        if (minDistSqr < 0 || distSqr < minDistSqr)
+            minDistSqr = distSqr;
+    }
+    return Math::Sqrt(minDistSqr);
+}
+
+void MapStreamer::Update()
+{
+    if (m_Loader)
+    {
+        if (!m_Loader->IsReady())
+            return;
+
+        UniqueRef<MapLoader> loader = std::move(m_Loader);
+        if (loader->IsFailed())
+        {
+            m_World = nullptr;
+            return;
+        }
+        loader->StartStreaming(m_World, *this, m_DefaultMaterial);
+    }
+
+    if (!m_World)
+        return;
+
+    Vector<Float3> sources = m_SourcePositions;
+    for (int i = 0; i < m_Sources.Size();)
+    {
+        if (GameObject* source = m_World->GetObject(m_Sources[i]))
+        {
+            sources.Add(source->GetWorldPosition());
+            ++i;
+        }
+        else
+            m_Sources.Remove(i);
+    }
+
+    if (sources.IsEmpty())
+        return;
+
+    struct SectorDistance
+    {
+        float       Distance;
+        int         SectorIndex;
+    };
+
+    Vector<SectorDistance> candidates;
+    Vector<SectorDistance> evictable;
+
+    bool cancelled = false;
+    for (int sectorIndex = 0; sectorIndex < m_Sectors.Size(); ++sectorIndex)
+    {
+        Sector& sector = m_Sectors[sectorIndex];
+
+        float distance = GetSourceDistance(sector, sources);
+
+        switch (sector.State)
+        {
+            case SectorState::Unloaded:
+                if (distance <= LoadDistance)
+                    candidates.Add({distance, sectorIndex});
+                break;
+
+            case SectorState::Loading:
+                if (distance > UnloadDistance)
+                {
+                    // The request is dropped below
+                    sector.State = SectorState::Unloaded;
+                    m_PendingMemory -= sector.Memory;
+                    m_LoadingSectorCount--;
+                    cancelled = true;
+                }
+                break;
+
+            case SectorState::Loaded:
+                if (distance > UnloadDistance)
+                    UnloadSector(sectorIndex);
+                else if (distance > LoadDistance)
+                    evictable.Add({distance, sectorIndex});
+                break;
+        }
+    }
+
+    // Over budget: drop sectors from the hysteresis band, farthest first
+    if (m_ResidentMemory + m_PendingMemory > MemoryBudget)
+    {
+        std::sort(evictable.begin(), evictable.end(), [](SectorDistance const& a, SectorDistance const& b) { return a.Distance > b.Distance; });
+
+        for (auto& entry : evictable)
+        {
+            if (m_ResidentMemory + m_PendingMemory <= MemoryBudget)
+                break;
+            UnloadSector(entry.SectorIndex);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](SectorDistance const& a, SectorDistance const& b) { return a.Distance < b.Distance; });
+
+    if (cancelled)
+    {
+        for (int i = 0; i < m_Requests.Size();)
+        {
+            if (m_Sectors[m_Requests[i]].State != SectorState::Loading)
+                m_Requests.Remove(i);
+            else
+                ++i;
+        }
+    }
+
+    bool requested = false;
+    for (auto& entry : candidates)
+    {
+        Sector& sector = m_Sectors[entry.SectorIndex];
+
+        if (m_ResidentMemory + m_PendingMemory + sector.Memory > MemoryBudget)
+            break;
+
+        sector.State = SectorState::Loading;
+        m_PendingMemory += sector.Memory;
+        m_LoadingSectorCount++;
+
+        m_Requests.Add(entry.SectorIndex);
+        requested = true;
+    }
+
+    // Keep the queue nearest first
+    if (requested)
+    {
+        std::sort(m_Requests.begin(), m_Requests.end(), [this, &sources](int a, int b)
+            {
+                return GetSourceDistance(m_Sectors[a], sources) < GetSourceDistance(m_Sectors[b], sources);
+            });
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    // Resources and objects are created on the main thread, so spread the sectors over frames.
+    // At least one sector is loaded per call so that streaming always advances.
+    auto deadline = Clock::now() + std::chrono::microseconds(int64_t(BudgetMs * 1000));
+
+    while (!m_Requests.IsEmpty())
+    {
+        int sectorIndex = m_Requests[0];
+        m_Requests.Remove(0);
+
+        LoadSector(sectorIndex);
+
+        if (Clock::now() >= deadline)
+            break;
+    }
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,150 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "MapGeometry.h"
+
+#include <Hork/Core/String.h>
+#include <Hork/World/World.h>
+#include <Hork/Resources/ResourceManager.h>
+
+HK_NAMESPACE_BEGIN
+
+class MeshResource;
+class MeshCollisionData;
+class MapLoader;
+
+// Loads and unloads map sectors around streaming sources (e.g. player cameras).
+// Sector meshes, collision data and objects are created on the main thread within a time budget per frame.
+// Call Deinitialize() before the world is destroyed, the destructor doesn't touch the world.
+class MapStreamer final
+{
+public:
+    // Horizontal size of a sector. Worldspawn is clustered by the same grid.
+    float               SectorSize = 64;
+
+    // Sectors closer than LoadDistance to any source are loaded
+    float               LoadDistance = 96;
+
+    // Sectors farther than UnloadDistance from all sources are unloaded. Sectors in between keep their state.
+    float               UnloadDistance = 128;
+
+    // Approximate limit of vertex, index and collision data of loaded sectors
+    size_t              MemoryBudget = 256 << 20;
+
+    // Time budget of sector creation per frame in milliseconds
+    float               BudgetMs = 2;
+
+                        MapStreamer() = default;
+                        ~MapStreamer();
+
+                        MapStreamer(MapStreamer const&) = delete;
+    MapStreamer&        operator=(MapStreamer const&) = delete;
+
+    // Starts streaming a built map. Sources added before are kept.
+    void                Initialize(World* world, MapGeometry&& geometry, StringView name, StringView defaultMaterial);
+
+    // Reads, parses and builds the map on a worker thread. Update() starts streaming when it is ready.
+    void                LoadAsync(World* world, StringView mapFilename, StringView defaultMaterial);
+
+    // Unloads all sectors and cancels the map load. The world must still exist.
+    void                Deinitialize();
+
+    void                AddSource(GameObjectHandle source);
+    void                RemoveSource(GameObjectHandle source);
+
+    // Fixed points that keep the sectors around them loaded, e.g. spawn points
+    void                AddSourcePosition(Float3 const& position);
+
+    // Issues load/unload requests and loads the nearest requested sectors. Call once per frame on the main thread.
+    void                Update();
+
+    // True while the map is being built or sectors near the sources are being prepared
+    bool                IsLoading() const { return m_Loader || m_LoadingSectorCount > 0; }
+
+    int                 GetSectorCount() const { return m_Sectors.Size(); }
+    int                 GetLoadedSectorCount() const { return m_LoadedSectorCount; }
+    size_t              GetResidentMemory() const { return m_ResidentMemory; }
+
+private:
+    enum class SectorState
+    {
+        Unloaded,
+        Loading,
+        Loaded
+    };
+
+    struct Sector
+    {
+        BvAxisAlignedBox Bounds;
+        Vector<int>     Entities;
+        Vector<int>     Surfaces;
+        Vector<int>     ClipHulls;
+        size_t          Memory = 0;
+        SectorState     State = SectorState::Unloaded;
+        Vector<GameObjectHandle> Objects;
+    };
+
+    void                Release();
+    void                CreateSectors();
+    void                LoadSector(int sectorIndex);
+    void                UnloadSector(int sectorIndex);
+    void                ReleaseSectorResources(int sectorIndex);
+    float               GetSourceDistance(Sector const& sector, Vector<Float3> const& sources) const;
+
+    World*              m_World{};
+    MapGeometry         m_Geometry;
+    String              m_Name;
+    String              m_DefaultMaterial;
+
+    UniqueRef<MapLoader> m_Loader;
+
+    Vector<Sector>      m_Sectors;
+    Vector<GameObjectHandle> m_Sources;
+    Vector<Float3>      m_SourcePositions;
+    int                 m_LoadedSectorCount = 0;
+    int                 m_LoadingSectorCount = 0;
+    size_t              m_ResidentMemory = 0;
+    size_t              m_PendingMemory = 0;
+
+    // Surfaces and clip hulls can be shared by several sectors through instancing
+    Vector<MeshHandle>  m_SurfaceMeshes;
+    Vector<BvAxisAlignedBox> m_SurfaceBounds;
+    Vector<int>         m_SurfaceRefs;
+    Vector<int>         m_SurfaceGeneration;
+    Vector<Ref<MeshCollisionData>> m_ClipHullData;
+    Vector<int>         m_ClipHullRefs;
+
+    // Sectors to load, nearest first
+    Vector<int>         m_Requests;
+};
+
+HK_NAMESPACE_END
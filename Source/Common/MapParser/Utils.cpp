@@ -28,7 +28,9 @@ SOFTWARE.
 
 */
 
-#include "MapGeometry.h"
+#include "Utils.h"
+#include "../TraceProfiler.h"
+#include "../Interfaces/DestructionInterface.h"
 
 #include <Hork/World/World.h>
 #include <Hork/World/Modules/Render/Components/MeshComponent.h>
@@ -37,104 +39,325 @@ SOFTWARE.
 
 HK_NAMESPACE_BEGIN
 
+namespace
+{
+    // Keeps resource names unique when the same map is instantiated more than once
+    int MapInstanceCounter = 0;
+}
+
 void CreateSceneFromMap(World* world, StringView mapFilename, StringView defaultMaterial)
 {
-    auto& resourceMngr = GameApplication::sGetResourceManager();
+    HK_TRACE_ZONE("CreateSceneFromMap");
+
+    MapLoader loader;
+    if (loader.Load(mapFilename))
+        loader.CreateScene(world, defaultMaterial);
+}
+
+void CreateSceneFromMap(World* world, StringView mapFilename, MapStreamer& streamer, StringView defaultMaterial)
+{
+    streamer.LoadAsync(world, mapFilename, defaultMaterial);
+}
+
+UniqueRef<MeshResource> CreateMapSurfaceMesh(MapGeometry const& geometry, int surfaceIndex, BvAxisAlignedBox& bounds)
+{
+    auto& surface = geometry.GetSurfaces()[surfaceIndex];
+    auto& vertices = geometry.GetVertices();
+    auto& indices = geometry.GetIndices();
+
+    bounds.Clear();
+    for (int v = 0; v < surface.VertexCount; ++v)
+        bounds.AddPoint(vertices[surface.FirstVert + v].Position);
+
+    MeshAllocateDesc alloc;
+    alloc.SurfaceCount = 1;
+    alloc.VertexCount = surface.VertexCount;
+    alloc.IndexCount = surface.IndexCount;
+
+    UniqueRef<MeshResource> resource = MakeUnique<MeshResource>();
+    resource->Allocate(alloc);
+    resource->WriteVertexData(&vertices[surface.FirstVert], surface.VertexCount, 0);
+    resource->WriteIndexData(&indices[surface.FirstIndex], surface.IndexCount, 0);
+    resource->SetBoundingBox(bounds);
+
+    MeshSurface& meshSurface = resource->LockSurface(0);
+    meshSurface.BoundingBox = bounds;
+
+    return resource;
+}
+
+Ref<MeshCollisionData> CreateMapClipHullData(MapGeometry const& geometry, int hullIndex)
+{
+    auto& chull = geometry.GetClipHulls()[hullIndex];
+    auto& clipVertices = geometry.GetClipVertices();
+
+    Ref<MeshCollisionData> collisionData = MakeRef<MeshCollisionData>();
+    collisionData->CreateConvexHull(ArrayView(&clipVertices[chull.FirstVert], chull.VertexCount));
+
+    //collisionData->CreateTriangleSoup(ArrayView(&clipVertices[chull.FirstVert], chull.VertexCount),
+    //                                  ArrayView(&clipIndices[chull.FirstIndex], chull.IndexCount));
+
+    return collisionData;
+}
+
+GameObject* CreateMapEntity(World* world, MapGeometry::Entity const& entity, MeshHandle const* surfaceMeshes, BvAxisAlignedBox const* surfaceBounds, Ref<MeshCollisionData> const* hullData, StringView defaultMaterial)
+{
     auto& materialMngr = GameApplication::sGetMaterialManager();
 
-    if (auto file = resourceMngr.OpenFile(mapFilename))
+    GameObjectDesc desc;
+    desc.Position = entity.Origin;
+    GameObject* object;
+    world->CreateObject(desc, object);
+
+    for (int surfaceNum = 0; surfaceNum < entity.SurfaceCount; ++surfaceNum)
     {
-        MapParser parser;
-        parser.Parse(file.AsString().CStr());
-
-        MapGeometry geometry;
-        geometry.Build(parser);
-
-        auto& surfaces = geometry.GetSurfaces();
-        auto& vertices = geometry.GetVertices();
-        auto& indices = geometry.GetIndices();
-        auto& clipVertices = geometry.GetClipVertices();
-        //auto& clipIndices = geometry.GetClipIndices();
-        auto& clipHull = geometry.GetClipHulls();
-        auto& entities = geometry.GetEntities();
-
-        for (int i = 0; i < entities.Size(); ++i)
-        {
-            auto& entity = entities[i];
-
-            GameObjectDesc desc;
-            GameObject* object;
-            world->CreateObject(desc, object);
-
-            for (int surfaceNum = 0; surfaceNum < entity.SurfaceCount; ++surfaceNum)
-            {
-                int surfaceIndex = entity.FirstSurface + surfaceNum;
-                auto& surface = surfaces[surfaceIndex];
-                auto surfaceHandle = GameApplication::sGetResourceManager().CreateResource<MeshResource>("surface_" + Core::ToString(surfaceIndex));
-
-                MeshResource* resource = GameApplication::sGetResourceManager().TryGet(surfaceHandle);
-                HK_ASSERT(resource);
-
-                BvAxisAlignedBox bounds;
-                bounds.Clear();
-                for (int v = 0; v < surface.VertexCount; ++v)
-                    bounds.AddPoint(vertices[surface.FirstVert + v].Position);
-
-                MeshAllocateDesc alloc;
-                alloc.SurfaceCount = 1;
-                alloc.VertexCount = surface.VertexCount;
-                alloc.IndexCount = surface.IndexCount;
-
-                resource->Allocate(alloc);
-                resource->WriteVertexData(&vertices[surface.FirstVert], surface.VertexCount, 0);
-                resource->WriteIndexData(&indices[surface.FirstIndex], surface.IndexCount, 0);
-                resource->SetBoundingBox(bounds);
-
-                MeshSurface& meshSurface = resource->LockSurface(0);
-                meshSurface.BoundingBox = bounds;
-
-                StaticMeshComponent* mesh;
-                object->CreateComponent(mesh);
-                mesh->SetMesh(surfaceHandle);
-                mesh->SetMaterial(materialMngr.TryGet(defaultMaterial));
-                mesh->SetLocalBoundingBox(bounds);
-            }
-
-            //#define SINGLE_OBJECT
+        int surfaceIndex = entity.FirstSurface + surfaceNum;
+
+        StaticMeshComponent* mesh;
+        object->CreateComponent(mesh);
+        mesh->SetMesh(surfaceMeshes[surfaceIndex]);
+        mesh->SetMaterial(materialMngr.TryGet(defaultMaterial));
+        mesh->SetLocalBoundingBox(surfaceBounds[surfaceIndex]);
+    }
+
+    //#define SINGLE_OBJECT
 
 #ifdef SINGLE_OBJECT
-            if (entity.ClipHullCount > 0)
-            {
-                StaticBodyComponent* body;
-                object->CreateComponent(body);
-            }
+    if (entity.ClipHullCount > 0)
+    {
+        StaticBodyComponent* body;
+        object->CreateComponent(body);
+    }
 #endif
 
-            for (int hullNum = 0; hullNum < entity.ClipHullCount; ++hullNum)
-            {
-                auto& chull = clipHull[entity.FirstClipHull + hullNum];
+    for (int hullNum = 0; hullNum < entity.ClipHullCount; ++hullNum)
+    {
+        int hullIndex = entity.FirstClipHull + hullNum;
 
 #ifdef SINGLE_OBJECT
-                MeshCollider* collider;
-                object->CreateComponent(collider);
+        MeshCollider* collider;
+        object->CreateComponent(collider);
 #else
-                GameObjectDesc collisionObjectDesc;
-                collisionObjectDesc.Parent = object->GetHandle();
-                GameObject* collisionObject;
-                world->CreateObject(desc, collisionObject);
-                StaticBodyComponent* body;
-                collisionObject->CreateComponent(body);
-                MeshCollider* collider;
-                collisionObject->CreateComponent(collider);
+        // Collision objects are attached to the entity object so they are destroyed with it
+        GameObjectDesc collisionObjectDesc;
+        collisionObjectDesc.Parent = object->GetHandle();
+        GameObject* collisionObject;
+        world->CreateObject(collisionObjectDesc, collisionObject);
+        StaticBodyComponent* body;
+        collisionObject->CreateComponent(body);
+        MeshCollider* collider;
+        collisionObject->CreateComponent(collider);
 #endif
-                collider->Data = MakeRef<MeshCollisionData>();
-                collider->Data->CreateConvexHull(ArrayView(&clipVertices[chull.FirstVert], chull.VertexCount));
+        collider->Data = hullData[hullIndex];
+    }
+
+    return object;
+}
+
+MapLoader::MapLoader() = default;
+
+MapLoader::~MapLoader()
+{
+    WaitWorker();
+}
+
+void MapLoader::WaitWorker()
+{
+    if (m_Thread.joinable())
+        m_Thread.join();
+}
+
+bool MapLoader::Load(StringView mapFilename, MapGeometrySettings const& settings, MapLoadMode mode)
+{
+    if (!BeginLoad(mapFilename, settings, mode))
+        return false;
+
+    LoadInternal();
 
-                //collider->Data->CreateTriangleSoup(ArrayView(&clipVertices[chull.FirstVert], chull.VertexCount),
-                //                                   ArrayView(&clipIndices[chull.FirstIndex], chull.IndexCount));
-            }
-        }
+    return !IsFailed();
+}
+
+void MapLoader::LoadAsync(StringView mapFilename, MapGeometrySettings const& settings, MapLoadMode mode)
+{
+    if (!BeginLoad(mapFilename, settings, mode))
+        return;
+
+    m_Thread = std::thread([this]() { LoadInternal(); });
+}
+
+bool MapLoader::BeginLoad(StringView mapFilename, MapGeometrySettings const& settings, MapLoadMode mode)
+{
+    auto& resourceMngr = GameApplication::sGetResourceManager();
+
+    WaitWorker();
+
+    m_MapFilename = mapFilename;
+    m_Settings = settings;
+    m_Mode = mode;
+    m_Geometry = {};
+    m_Geometry.SetMemoryReport(m_MemoryReport);
+    m_SurfaceBounds.Clear();
+    m_CollisionData.Clear();
+    m_MeshMemory.Set(0);
+    m_CollisionMemory.Set(0);
+
+    // The resource manager is used on the main thread only, so the file is read here
+    auto file = resourceMngr.OpenFile(m_MapFilename);
+    if (!file)
+    {
+        LOG("MapLoader: Failed to open {}\n", m_MapFilename);
+        m_State.store(State::Failed, std::memory_order_release);
+        return false;
     }
+    m_Source = file.AsString();
+
+    m_State.store(State::Loading, std::memory_order_relaxed);
+    return true;
+}
+
+void MapLoader::LoadInternal()
+{
+    HK_TRACE_ZONE("MapLoader::Load");
+
+    // Only the map data owned by the loader is touched here. Resources are created by CreateScene on the main thread.
+    {
+        MapParser parser;
+        parser.SetMemoryReport(m_MemoryReport);
+        parser.Parse(m_Source.CStr());
+
+        m_Geometry.Build(parser, m_Settings);
+    }
+
+    if (m_Settings.MergeClipHulls)
+        LOG("MapLoader: {} clip hulls {} -> {}\n", m_MapFilename, m_Geometry.GetSourceClipHullCount(), m_Geometry.GetMergedClipHullCount());
+
+    m_Source = {};
+
+    m_State.store(State::Ready, std::memory_order_release);
+}
+
+void MapLoader::CreateScene(World* world, StringView defaultMaterial)
+{
+    SceneConstructionQueue queue;
+    CreateScene(world, queue, defaultMaterial);
+    queue.Flush();
+}
+
+void MapLoader::CreateScene(World* world, SceneConstructionQueue& queue, StringView defaultMaterial)
+{
+    HK_TRACE_ZONE("MapLoader::CreateScene");
+
+    HK_ASSERT(IsReady());
+    HK_ASSERT(m_Mode == MapLoadMode::Resident);
+
+    WaitWorker();
+
+    if (IsFailed())
+        return;
+
+    // Instanced entities reference the surfaces and hulls of their prototype, so every surface and hull is unique here
+    int surfaceCount = m_Geometry.GetSurfaces().Size();
+    int hullCount = m_Geometry.GetClipHulls().Size();
+
+    m_Objects.Clear();
+    m_SurfaceMeshes.Clear();
+    m_SurfaceMeshes.Resize(surfaceCount);
+    m_SurfaceBounds.Resize(surfaceCount);
+    m_CollisionData.Clear();
+    m_CollisionData.Resize(hullCount);
+
+    // Meshes and collision data copy the vertices and indices of the geometry
+    m_MeshMemory.Set(m_Geometry.GetVertices().Size() * sizeof(MeshVertex) + m_Geometry.GetIndices().Size() * sizeof(uint32_t));
+    m_CollisionMemory.Set(m_Geometry.GetClipVertices().Size() * sizeof(Float3) + m_Geometry.GetClipIndices().Size() * sizeof(uint32_t));
+
+    // The map name keeps resource names unique when several maps are loaded
+    m_ResourcePrefix = m_MapFilename + "/" + Core::ToString(MapInstanceCounter++);
+
+    for (int surfaceIndex = 0; surfaceIndex < surfaceCount; ++surfaceIndex)
+        queue.Add([this, surfaceIndex]() { RegisterMesh(surfaceIndex); });
+
+    for (int hullIndex = 0; hullIndex < hullCount; ++hullIndex)
+        queue.Add([this, hullIndex]() { m_CollisionData[hullIndex] = CreateMapClipHullData(m_Geometry, hullIndex); });
+
+    String material(defaultMaterial);
+    for (int entityIndex = 0; entityIndex < m_Geometry.GetEntities().Size(); ++entityIndex)
+        queue.Add([this, world, entityIndex, material]() { CreateEntity(world, entityIndex, material); });
+}
+
+void MapLoader::RegisterMesh(int surfaceIndex)
+{
+    auto& resourceMngr = GameApplication::sGetResourceManager();
+
+    String resourceName = m_ResourcePrefix + "/surface_" + Core::ToString(surfaceIndex);
+
+    UniqueRef<MeshResource> mesh = CreateMapSurfaceMesh(m_Geometry, surfaceIndex, m_SurfaceBounds[surfaceIndex]);
+    mesh->Upload();
+    resourceMngr.CreateResourceWithData(resourceName, std::move(mesh));
+
+    m_SurfaceMeshes[surfaceIndex] = resourceMngr.GetResource<MeshResource>(resourceName);
+}
+
+void MapLoader::CreateEntity(World* world, int entityIndex, StringView defaultMaterial)
+{
+    GameObject* object = CreateMapEntity(world, m_Geometry.GetEntities()[entityIndex], m_SurfaceMeshes.ToPtr(), m_SurfaceBounds.ToPtr(), m_CollisionData.ToPtr(), defaultMaterial);
+    m_Objects.Add(object->GetHandle());
+}
+
+void MapLoader::PurgeResources()
+{
+    auto& resourceMngr = GameApplication::sGetResourceManager();
+
+    WaitWorker();
+
+    for (MeshHandle& handle : m_SurfaceMeshes)
+    {
+        if (handle.IsValid())
+            resourceMngr.PurgeResourceData(handle);
+    }
+
+    m_SurfaceMeshes.Clear();
+    m_SurfaceBounds.Clear();
+    m_CollisionData.Clear();
+    m_Objects.Clear();
+
+    m_MeshMemory.Set(0);
+    m_CollisionMemory.Set(0);
+}
+
+void MapLoader::DestroyScene(World* world)
+{
+    auto& destruction = world->GetInterface<DestructionInterface>();
+
+    for (GameObjectHandle handle : m_Objects)
+        destruction.Destroy(handle);
+    m_Objects.Clear();
+
+    destruction.OnDestroyed([this]() { PurgeResources(); });
+}
+
+void MapLoader::StartStreaming(World* world, MapStreamer& streamer, StringView defaultMaterial)
+{
+    HK_ASSERT(IsReady());
+    HK_ASSERT(m_Mode == MapLoadMode::Streaming);
+
+    WaitWorker();
+
+    if (IsFailed())
+        return;
+
+    streamer.Initialize(world, std::move(m_Geometry), m_MapFilename, defaultMaterial);
+    m_Geometry = {};
+    m_Geometry.SetMemoryReport(m_MemoryReport);
+}
+
+void MapLoader::SetMemoryReport(MemoryReport* report)
+{
+    WaitWorker();
+
+    m_MemoryReport = report;
+    m_Geometry.SetMemoryReport(report);
+    m_MeshMemory.SetReport(report);
+    m_CollisionMemory.SetReport(report);
 }
 
 HK_NAMESPACE_END
@@ -30,12 +30,118 @@ SOFTWARE.
 
 #pragma once
 
+#include "MapGeometry.h"
+#include "MapStreamer.h"
+#include "../SceneConstructionQueue.h"
+
 #include <Hork/Core/String.h>
+#include <Hork/Geometry/BV/BvAxisAlignedBox.h>
+#include <Hork/Resources/ResourceManager.h>
+
+#include <atomic>
+#include <thread>
 
 HK_NAMESPACE_BEGIN
 
 class World;
+class GameObject;
+class MeshResource;
+class MeshCollisionData;
 
 void CreateSceneFromMap(World* world, StringView mapFilename, StringView defaultMaterial = "grid8");
 
+// Loads the map in streaming mode on a worker thread. Sectors are created around the streamer sources on MapStreamer::Update().
+void CreateSceneFromMap(World* world, StringView mapFilename, MapStreamer& streamer, StringView defaultMaterial = "grid8");
+
+// Creates a mesh resource for a map surface. Main thread only.
+UniqueRef<MeshResource> CreateMapSurfaceMesh(MapGeometry const& geometry, int surfaceIndex, BvAxisAlignedBox& bounds);
+
+// Creates convex collision data for a map clip hull. Main thread only.
+Ref<MeshCollisionData> CreateMapClipHullData(MapGeometry const& geometry, int hullIndex);
+
+// Creates the object of a map entity with its meshes and colliders. The arrays are indexed by global surface and hull indices.
+GameObject* CreateMapEntity(World* world, MapGeometry::Entity const& entity, MeshHandle const* surfaceMeshes, BvAxisAlignedBox const* surfaceBounds, Ref<MeshCollisionData> const* hullData, StringView defaultMaterial);
+
+enum class MapLoadMode
+{
+    // Prepare resources for the whole map
+    Resident,
+
+    // Keep only the geometry; resources are created by MapStreamer per sector
+    Streaming
+};
+
+// Reads, parses and builds a map, then creates its mesh resources, collision data and objects.
+// The file is read on the calling thread and parsing and building can run on a worker thread.
+// Resources are created by CreateScene on the main thread.
+class MapLoader final
+{
+public:
+                        MapLoader();
+                        ~MapLoader();
+
+    // Loads the map on the calling thread
+    bool                Load(StringView mapFilename, MapGeometrySettings const& settings = {}, MapLoadMode mode = MapLoadMode::Resident);
+
+    // Reads the map file and parses and builds it on a worker thread. Poll IsReady() before calling CreateScene().
+    void                LoadAsync(StringView mapFilename, MapGeometrySettings const& settings = {}, MapLoadMode mode = MapLoadMode::Resident);
+
+    // Returns true when loading is finished, successfully or not
+    bool                IsReady() const { return m_State.load(std::memory_order_acquire) >= State::Ready; }
+    bool                IsFailed() const { return m_State.load(std::memory_order_acquire) == State::Failed; }
+
+    // Creates and registers the resources and creates the map objects. Main thread only.
+    void                CreateScene(World* world, StringView defaultMaterial = "grid8");
+
+    // Same as above, but the work is added to the queue to be spread over several frames.
+    // The loader must stay alive until the queue is processed.
+    void                CreateScene(World* world, SceneConstructionQueue& queue, StringView defaultMaterial = "grid8");
+
+    // Hands the geometry over to the streamer. Requires MapLoadMode::Streaming. Main thread only.
+    void                StartStreaming(World* world, MapStreamer& streamer, StringView defaultMaterial = "grid8");
+
+    // Releases the mesh resources registered by CreateScene. Objects using them must be destroyed first.
+    void                PurgeResources();
+
+    // Queues the objects created by CreateScene to the DestructionInterface of the world and releases the
+    // mesh resources once they are destroyed. The loader must stay alive until then.
+    void                DestroyScene(World* world);
+
+    MapGeometry const&  GetGeometry() const { return m_Geometry; }
+
+    // Adds the memory of the map data to the report. The report must outlive the loader or be replaced first.
+    void                SetMemoryReport(MemoryReport* report);
+
+private:
+    enum class State
+    {
+        Empty,
+        Loading,
+        Ready,
+        Failed
+    };
+
+    bool                BeginLoad(StringView mapFilename, MapGeometrySettings const& settings, MapLoadMode mode);
+    void                LoadInternal();
+    void                WaitWorker();
+    void                RegisterMesh(int surfaceIndex);
+    void                CreateEntity(World* world, int entityIndex, StringView defaultMaterial);
+
+    String              m_MapFilename;
+    String              m_ResourcePrefix;
+    MapGeometrySettings m_Settings;
+    MapLoadMode         m_Mode = MapLoadMode::Resident;
+    String              m_Source;
+    MapGeometry         m_Geometry;
+    Vector<BvAxisAlignedBox>        m_SurfaceBounds;
+    Vector<MeshHandle>              m_SurfaceMeshes;
+    Vector<Ref<MeshCollisionData>>  m_CollisionData;
+    Vector<GameObjectHandle>        m_Objects;
+    TaggedMemory        m_MeshMemory{MemoryTag::MeshData};
+    TaggedMemory        m_CollisionMemory{MemoryTag::CollisionData};
+    MemoryReport*       m_MemoryReport{};
+    std::atomic<State>  m_State{State::Empty};
+    std::thread         m_Thread;
+};
+
 HK_NAMESPACE_END
@@ -0,0 +1,193 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "MemoryTags.h"
+
+#include <Hork/Core/Logger.h>
+#include <Hork/GameApplication/GameApplication.h>
+
+#if defined(_WIN32)
+#    ifndef WIN32_LEAN_AND_MEAN
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#    include <psapi.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#    include <sys/resource.h>
+#endif
+
+HK_NAMESPACE_BEGIN
+
+namespace
+{
+    void UpdatePeak(std::atomic<size_t>& peak, size_t value)
+    {
+        size_t prev = peak.load(std::memory_order_relaxed);
+        while (value > prev && !peak.compare_exchange_weak(prev, value, std::memory_order_relaxed))
+        {}
+    }
+
+    double ToMegabytes(size_t bytes)
+    {
+        return bytes / (1024.0 * 1024.0);
+    }
+}
+
+MemoryTracker& MemoryTracker::sGet()
+{
+    static MemoryTracker tracker;
+    return tracker;
+}
+
+const char* MemoryTracker::sGetTagName(MemoryTag tag)
+{
+    switch (tag)
+    {
+        case MemoryTag::MapParser:
+            return "MapParser";
+        case MemoryTag::MapGeometry:
+            return "MapGeometry";
+        case MemoryTag::MeshData:
+            return "MeshData";
+        case MemoryTag::CollisionData:
+            return "CollisionData";
+        default:
+            return "Unknown";
+    }
+}
+
+void MemoryTracker::Alloc(MemoryTag tag, size_t bytes)
+{
+    Tag& t = m_Tags[size_t(tag)];
+
+    size_t current = t.Current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    t.GrowCount.fetch_add(1, std::memory_order_relaxed);
+
+    UpdatePeak(t.Peak, current);
+    UpdatePeak(m_TotalPeak, GetCurrent());
+}
+
+void MemoryTracker::Free(MemoryTag tag, size_t bytes)
+{
+    m_Tags[size_t(tag)].Current.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+MemoryTracker::TagStats MemoryTracker::GetStats(MemoryTag tag) const
+{
+    Tag const& t = m_Tags[size_t(tag)];
+
+    TagStats stats;
+    stats.Current = t.Current.load(std::memory_order_relaxed);
+    stats.Peak = t.Peak.load(std::memory_order_relaxed);
+    stats.GrowCount = t.GrowCount.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t MemoryTracker::sGetProcessPeakMemory()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#elif defined(__APPLE__)
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return size_t(usage.ru_maxrss);
+    return 0;
+#elif defined(__unix__)
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return size_t(usage.ru_maxrss) * 1024;
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+size_t MemoryTracker::GetCurrent() const
+{
+    size_t total = 0;
+    for (Tag const& t : m_Tags)
+        total += t.Current.load(std::memory_order_relaxed);
+    return total;
+}
+
+void MemoryTracker::RegisterCommands()
+{
+    GameApplication::sGetCommandContext().AddCommand("com_MemoryTags", {this, &MemoryTracker::MemoryTagsCommand}, "Print memory per subsystem");
+}
+
+void MemoryTracker::MemoryTagsCommand(CommandProcessor const& proc)
+{
+    LOG("Memory per subsystem:\n");
+    for (size_t i = 0; i < size_t(MemoryTag::Count); ++i)
+    {
+        TagStats stats = GetStats(MemoryTag(i));
+        LOG("  {:<16} current {:>8.2f} MB  peak {:>8.2f} MB  grows {}\n", sGetTagName(MemoryTag(i)), ToMegabytes(stats.Current), ToMegabytes(stats.Peak), stats.GrowCount);
+    }
+}
+
+void MemoryReport::Alloc(MemoryTag tag, size_t bytes)
+{
+    Tag& t = m_Tags[size_t(tag)];
+
+    UpdatePeak(t.Peak, t.Current.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    UpdatePeak(m_Peak, m_Current.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+void MemoryReport::Free(MemoryTag tag, size_t bytes)
+{
+    m_Tags[size_t(tag)].Current.fetch_sub(bytes, std::memory_order_relaxed);
+    m_Current.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void MemoryReport::Reset()
+{
+    for (Tag& t : m_Tags)
+        t.Peak.store(t.Current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_Peak.store(m_Current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void MemoryReport::Print(StringView title) const
+{
+    LOG("Memory: {}\n", title);
+    for (size_t i = 0; i < size_t(MemoryTag::Count); ++i)
+    {
+        Tag const& t = m_Tags[i];
+        LOG("  {:<16} current {:>8.2f} MB  peak {:>8.2f} MB\n", MemoryTracker::sGetTagName(MemoryTag(i)), ToMegabytes(t.Current.load(std::memory_order_relaxed)), ToMegabytes(t.Peak.load(std::memory_order_relaxed)));
+    }
+    LOG("  {:<16} current {:>8.2f} MB  peak {:>8.2f} MB\n", "Total", ToMegabytes(m_Current.load(std::memory_order_relaxed)), ToMegabytes(m_Peak.load(std::memory_order_relaxed)));
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,215 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/Core/String.h>
+
+#include <atomic>
+
+HK_NAMESPACE_BEGIN
+
+class CommandProcessor;
+
+enum class MemoryTag : uint8_t
+{
+    MapParser,
+    MapGeometry,
+    MeshData,
+    CollisionData,
+
+    Count
+};
+
+// Current bytes, peak bytes and growth count per subsystem. Subsystems report the memory of their
+// containers through TaggedMemory, so the numbers cover the data of the samples, not the engine heap.
+// The sizes are updated when a subsystem finishes a step of its work, so peaks inside a step are not
+// seen. com_MemoryTags prints a snapshot.
+class MemoryTracker final
+{
+public:
+    struct TagStats
+    {
+        size_t          Current;
+        size_t          Peak;
+        // Number of times the tagged size grew. One growth may cover several container reallocations.
+        size_t          GrowCount;
+    };
+
+    static MemoryTracker& sGet();
+
+    static const char*  sGetTagName(MemoryTag tag);
+
+    void                Alloc(MemoryTag tag, size_t bytes);
+    void                Free(MemoryTag tag, size_t bytes);
+
+    TagStats            GetStats(MemoryTag tag) const;
+
+    // Total of all tags
+    size_t              GetCurrent() const;
+
+    // Highest total of all tags since startup
+    size_t              GetPeak() const { return m_TotalPeak.load(std::memory_order_relaxed); }
+
+    // Peak resident memory of the process in bytes, zero when the platform doesn't report it
+    static size_t       sGetProcessPeakMemory();
+
+    // Registers com_MemoryTags
+    void                RegisterCommands();
+
+                        MemoryTracker(MemoryTracker const&) = delete;
+    MemoryTracker&      operator=(MemoryTracker const&) = delete;
+
+private:
+                        MemoryTracker() = default;
+
+    void                MemoryTagsCommand(CommandProcessor const& proc);
+
+    struct Tag
+    {
+        std::atomic<size_t> Current{0};
+        std::atomic<size_t> Peak{0};
+        std::atomic<size_t> GrowCount{0};
+    };
+
+    Tag                 m_Tags[size_t(MemoryTag::Count)];
+    std::atomic<size_t> m_TotalPeak{0};
+};
+
+// Current and peak bytes per tag of the memory owned by one client, e.g. one level load. Loads that run
+// at the same time keep separate reports, so their peaks don't mix.
+class MemoryReport final
+{
+public:
+                        MemoryReport() = default;
+
+    void                Alloc(MemoryTag tag, size_t bytes);
+    void                Free(MemoryTag tag, size_t bytes);
+
+    // Resets the peaks to the current bytes, e.g. at the start of a map load
+    void                Reset();
+
+    // Prints current bytes and peaks since Reset
+    void                Print(StringView title) const;
+
+                        MemoryReport(MemoryReport const&) = delete;
+    MemoryReport&       operator=(MemoryReport const&) = delete;
+
+private:
+    struct Tag
+    {
+        std::atomic<size_t> Current{0};
+        std::atomic<size_t> Peak{0};
+    };
+
+    Tag                 m_Tags[size_t(MemoryTag::Count)];
+    std::atomic<size_t> m_Current{0};
+    std::atomic<size_t> m_Peak{0};
+};
+
+// Bytes owned by an object under a tag. Moves with its owner and frees the bytes when destroyed.
+// The bytes are also added to the report of the owner, if it has one.
+class TaggedMemory final
+{
+public:
+    explicit            TaggedMemory(MemoryTag tag) : m_Tag(tag) {}
+
+                        ~TaggedMemory() { Set(0); }
+
+                        TaggedMemory(TaggedMemory&& rhs) noexcept :
+                            m_Tag(rhs.m_Tag), m_Bytes(rhs.m_Bytes), m_Report(rhs.m_Report)
+                        {
+                            rhs.m_Bytes = 0;
+                        }
+
+    TaggedMemory&       operator=(TaggedMemory&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            Set(0);
+            m_Tag = rhs.m_Tag;
+            m_Bytes = rhs.m_Bytes;
+            m_Report = rhs.m_Report;
+            rhs.m_Bytes = 0;
+        }
+        return *this;
+    }
+
+                        TaggedMemory(TaggedMemory const&) = delete;
+    TaggedMemory&       operator=(TaggedMemory const&) = delete;
+
+    // Replaces the owned size
+    void                Set(size_t bytes)
+    {
+        if (bytes > m_Bytes)
+        {
+            MemoryTracker::sGet().Alloc(m_Tag, bytes - m_Bytes);
+            if (m_Report)
+                m_Report->Alloc(m_Tag, bytes - m_Bytes);
+        }
+        else if (bytes < m_Bytes)
+        {
+            MemoryTracker::sGet().Free(m_Tag, m_Bytes - bytes);
+            if (m_Report)
+                m_Report->Free(m_Tag, m_Bytes - bytes);
+        }
+        m_Bytes = bytes;
+    }
+
+    size_t              GetBytes() const { return m_Bytes; }
+
+    // Moves the owned bytes to another report. The report must outlive the owner or be replaced first.
+    void                SetReport(MemoryReport* report)
+    {
+        if (m_Report == report)
+            return;
+        if (m_Report)
+            m_Report->Free(m_Tag, m_Bytes);
+        if (report)
+            report->Alloc(m_Tag, m_Bytes);
+        m_Report = report;
+    }
+
+    MemoryReport*       GetReport() const { return m_Report; }
+
+private:
+    MemoryTag           m_Tag;
+    size_t              m_Bytes = 0;
+    MemoryReport*       m_Report{};
+};
+
+// Bytes of the storage of a container
+template <typename T>
+HK_INLINE size_t GetContainerBytes(T const& container)
+{
+    return container.Capacity() * sizeof(*container.ToPtr());
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,65 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/Core/BaseTypes.h>
+
+HK_NAMESPACE_BEGIN
+
+// PCG32 random numbers. The seed goes through splitmix64, so that close seeds give unrelated sequences.
+// A seed gives the same sequence on every platform.
+class Pcg32 final
+{
+public:
+    explicit            Pcg32(uint32_t seed = 0) { SetSeed(seed); }
+
+    void                SetSeed(uint32_t seed)
+    {
+        uint64_t z = seed + 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        m_State = z ^ (z >> 31);
+    }
+
+    uint32_t            Get()
+    {
+        uint64_t state = m_State;
+        m_State = state * 6364136223846793005ull + 1442695040888963407ull;
+        uint32_t xorshifted = uint32_t(((state >> 18) ^ state) >> 27);
+        uint32_t rot = uint32_t(state >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+private:
+    uint64_t            m_State;
+};
+
+HK_NAMESPACE_END
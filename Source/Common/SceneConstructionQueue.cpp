@@ -0,0 +1,91 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "SceneConstructionQueue.h"
+#include "TraceProfiler.h"
+
+#include <chrono>
+
+HK_NAMESPACE_BEGIN
+
+void SceneConstructionQueue::Add(Task task)
+{
+    m_Tasks.Add(std::move(task));
+}
+
+bool SceneConstructionQueue::Process()
+{
+    HK_TRACE_ZONE("SceneConstructionQueue::Process");
+
+    using Clock = std::chrono::steady_clock;
+
+    auto deadline = Clock::now() + std::chrono::microseconds(int64_t(BudgetMs * 1000));
+
+    // At least one task is executed per call so that the queue always advances
+    while (!IsEmpty())
+    {
+        Task task = std::move(m_Tasks[m_NextTask++]);
+        task();
+
+        if (Clock::now() >= deadline)
+            break;
+    }
+
+    if (IsEmpty())
+    {
+        Clear();
+        return true;
+    }
+    return false;
+}
+
+void SceneConstructionQueue::Flush()
+{
+    // Tasks may add new tasks, so don't cache the size
+    while (!IsEmpty())
+    {
+        Task task = std::move(m_Tasks[m_NextTask++]);
+        task();
+    }
+    Clear();
+}
+
+void SceneConstructionQueue::Clear()
+{
+    m_Tasks.Clear();
+    m_NextTask = 0;
+}
+
+float SceneConstructionQueue::GetProgress() const
+{
+    return m_Tasks.IsEmpty() ? 1.0f : float(m_NextTask) / m_Tasks.Size();
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,69 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/Core/Containers/Vector.h>
+
+#include <functional>
+
+HK_NAMESPACE_BEGIN
+
+// Spreads scene construction over several frames. Tasks run in the order they were added
+// until the time budget of the frame is spent.
+class SceneConstructionQueue final
+{
+public:
+    using Task = std::function<void()>;
+
+    // Time budget per Process() call in milliseconds
+    float               BudgetMs = 4;
+
+    void                Add(Task task);
+
+    // Runs tasks until the budget is spent. Returns true when the queue is empty.
+    bool                Process();
+
+    // Runs all pending tasks
+    void                Flush();
+
+    void                Clear();
+
+    bool                IsEmpty() const { return m_NextTask == m_Tasks.Size(); }
+
+    // Fraction of completed tasks in range [0..1]
+    float               GetProgress() const;
+
+private:
+    Vector<Task>        m_Tasks;
+    int                 m_NextTask = 0;
+};
+
+HK_NAMESPACE_END
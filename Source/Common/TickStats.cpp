@@ -0,0 +1,185 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "TickStats.h"
+
+#include <Hork/Core/Logger.h>
+#include <Hork/GameApplication/GameApplication.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#ifdef __GNUG__
+#    include <cxxabi.h>
+#endif
+
+HK_NAMESPACE_BEGIN
+
+namespace
+{
+    std::mutex RegisterMutex;
+}
+
+TickStats& TickStats::sGet()
+{
+    static TickStats stats;
+    return stats;
+}
+
+TickStats::TickStats()
+{
+    m_WindowStart = std::chrono::steady_clock::now();
+    m_WindowStartCycles = sReadCycles();
+}
+
+TickStats::~TickStats()
+{
+    for (Entry* entry : m_Entries)
+        delete entry;
+}
+
+TickStats::Entry& TickStats::Register(const char* typeName, const char* groupName)
+{
+    std::lock_guard<std::mutex> lock(RegisterMutex);
+
+    for (Entry* entry : m_Entries)
+        if (!strcmp(entry->TypeName, typeName) && !strcmp(entry->GroupName, groupName))
+            return *entry;
+
+    Entry* entry = new Entry;
+    entry->TypeName = typeName;
+    entry->GroupName = groupName;
+    m_Entries.Add(entry);
+    return *entry;
+}
+
+const char* TickStats::sDemangle(const char* name)
+{
+#ifdef __GNUG__
+    int status = 0;
+    // Kept for the lifetime of the application, one string per type
+    if (char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status))
+        name = demangled;
+#else
+    if (!strncmp(name, "class ", 6))
+        name += 6;
+    else if (!strncmp(name, "struct ", 7))
+        name += 7;
+#endif
+    if (!strncmp(name, "Hk::", 4))
+        name += 4;
+    return name;
+}
+
+void TickStats::GetEntries(Vector<Entry const*>& entries) const
+{
+    std::lock_guard<std::mutex> lock(RegisterMutex);
+
+    entries.Clear();
+    for (Entry const* entry : m_Entries)
+        entries.Add(entry);
+}
+
+void TickStats::GetTop(int count, Vector<Entry const*>& top) const
+{
+    std::lock_guard<std::mutex> lock(RegisterMutex);
+
+    GetTopLocked(count, top);
+}
+
+void TickStats::GetTopLocked(int count, Vector<Entry const*>& top) const
+{
+    top.Clear();
+    for (Entry const* entry : m_Entries)
+        if (entry->WindowCalls)
+            top.Add(entry);
+
+    std::sort(top.begin(), top.end(), [](Entry const* a, Entry const* b) { return a->WindowCycles > b->WindowCycles; });
+
+    if (top.Size() > count)
+        top.Resize(count);
+}
+
+void TickStats::RegisterCommands()
+{
+    GameApplication::sGetCommandContext().AddCommand("com_TickStats", {this, &TickStats::TickStatsCommand}, "Print the N most expensive tick types every second, 0 to stop");
+}
+
+void TickStats::TickStatsCommand(CommandProcessor const& proc)
+{
+    m_PrintCount = proc.GetArgsCount() > 1 ? std::atoi(proc.GetArg(1)) : 10;
+}
+
+void TickStats::NextFrame()
+{
+    auto now = std::chrono::steady_clock::now();
+
+    double windowMs = std::chrono::duration<double, std::milli>(now - m_WindowStart).count();
+    if (windowMs < 1000)
+        return;
+
+    uint64_t cycles = sReadCycles();
+    if (cycles > m_WindowStartCycles)
+        m_MsPerCycle = windowMs / double(cycles - m_WindowStartCycles);
+
+    m_WindowStart = now;
+    m_WindowStartCycles = cycles;
+
+    std::lock_guard<std::mutex> lock(RegisterMutex);
+    for (Entry* entry : m_Entries)
+    {
+        uint64_t calls = entry->Calls.load(std::memory_order_relaxed);
+        uint64_t totalCycles = entry->Cycles.load(std::memory_order_relaxed);
+
+        entry->WindowCalls = calls - entry->PrevCalls;
+        entry->WindowCycles = totalCycles - entry->PrevCycles;
+        entry->PrevCalls = calls;
+        entry->PrevCycles = totalCycles;
+    }
+
+    if (m_PrintCount > 0)
+        Print();
+}
+
+void TickStats::Print() const
+{
+    Vector<Entry const*> top;
+    GetTopLocked(m_PrintCount, top);
+
+    LOG("Tick cost, last second:\n");
+    for (Entry const* entry : top)
+    {
+        LOG("  {:<32} {:<20} {:>8} calls {:>8.3f} ms\n", entry->TypeName, entry->GroupName, entry->WindowCalls, CyclesToMs(entry->WindowCycles));
+    }
+}
+
+HK_NAMESPACE_END
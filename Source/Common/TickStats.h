@@ -0,0 +1,173 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/Core/Containers/Vector.h>
+#include <Hork/Core/String.h>
+
+#include <atomic>
+#include <chrono>
+#include <typeinfo>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    include <intrin.h>
+#    define HK_TICK_STATS_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define HK_TICK_STATS_RDTSC
+#endif
+
+HK_NAMESPACE_BEGIN
+
+class CommandProcessor;
+
+// Call counts and CPU cycles of tick functions, per component or interface type and tick group.
+//
+//     void MoverInterface::FixedUpdate()
+//     {
+//         HK_TICK_COST("MoverInterface", "FixedUpdate");
+//         ...
+//     }
+//
+// Totals are kept since startup; the live table shows the last second. com_TickStats N prints the
+// top N types every second, com_TickStats 0 stops.
+class TickStats final
+{
+public:
+    struct Entry
+    {
+        const char*     TypeName;
+        const char*     GroupName;
+
+        // Since startup, updated from any thread
+        std::atomic<uint64_t> Calls{0};
+        std::atomic<uint64_t> Cycles{0};
+
+        // Last full second, updated by NextFrame
+        uint64_t        WindowCalls = 0;
+        uint64_t        WindowCycles = 0;
+        uint64_t        PrevCalls = 0;
+        uint64_t        PrevCycles = 0;
+    };
+
+    static TickStats&   sGet();
+
+    // Returns the same entry for the same pair of names. Entries live until the application exits.
+    Entry&              Register(const char* typeName, const char* groupName);
+
+    static uint64_t     sReadCycles()
+    {
+#ifdef HK_TICK_STATS_RDTSC
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    static void         sAdd(Entry& entry, uint64_t calls, uint64_t cycles)
+    {
+        entry.Calls.fetch_add(calls, std::memory_order_relaxed);
+        entry.Cycles.fetch_add(cycles, std::memory_order_relaxed);
+    }
+
+    // Readable name of a C++ type, for entries registered from templates
+    template <typename T>
+    static const char*  sTypeName()
+    {
+        static const char* name = sDemangle(typeid(T).name());
+        return name;
+    }
+
+    // All entries, for tools that sample the totals
+    void                GetEntries(Vector<Entry const*>& entries) const;
+
+    // Entries sorted by cycles of the last second, most expensive first
+    void                GetTop(int count, Vector<Entry const*>& top) const;
+
+    // Converts cycles to milliseconds, calibrated against the wall clock
+    double              CyclesToMs(uint64_t cycles) const { return cycles * m_MsPerCycle; }
+
+    // Registers com_TickStats
+    void                RegisterCommands();
+
+    // Call once per frame on the main thread
+    void                NextFrame();
+
+                        TickStats(TickStats const&) = delete;
+    TickStats&          operator=(TickStats const&) = delete;
+
+private:
+                        TickStats();
+                        ~TickStats();
+
+    static const char*  sDemangle(const char* name);
+
+    void                TickStatsCommand(CommandProcessor const& proc);
+
+    // Callers hold the register lock
+    void                GetTopLocked(int count, Vector<Entry const*>& top) const;
+    void                Print() const;
+
+    Vector<Entry*>      m_Entries;
+
+    int                 m_PrintCount = 0;
+
+    std::chrono::steady_clock::time_point m_WindowStart;
+    uint64_t            m_WindowStartCycles = 0;
+    double              m_MsPerCycle = 0;
+};
+
+class TickCostScope final
+{
+public:
+    explicit TickCostScope(TickStats::Entry& entry) :
+        m_Entry(entry),
+        m_Start(TickStats::sReadCycles())
+    {}
+
+    ~TickCostScope()
+    {
+        TickStats::sAdd(m_Entry, 1, TickStats::sReadCycles() - m_Start);
+    }
+
+    TickCostScope(TickCostScope const&) = delete;
+    TickCostScope& operator=(TickCostScope const&) = delete;
+
+private:
+    TickStats::Entry&   m_Entry;
+    uint64_t            m_Start;
+};
+
+#define HK_TICK_COST(typeName, groupName) \
+    static ::Hk::TickStats::Entry& tickCostEntry_ = ::Hk::TickStats::sGet().Register(typeName, groupName); \
+    ::Hk::TickCostScope tickCostScope_(tickCostEntry_)
+
+HK_NAMESPACE_END
@@ -0,0 +1,422 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "TraceProfiler.h"
+
+#include <Hork/Core/Logger.h>
+#include <Hork/GameApplication/GameApplication.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+HK_NAMESPACE_BEGIN
+
+std::atomic<bool> TraceProfiler::sEnabled{false};
+
+namespace
+{
+    // Returns the buffer to the pool when the thread exits
+    struct ThreadBufferHolder
+    {
+        std::atomic<bool>* InUse = nullptr;
+
+        ~ThreadBufferHolder()
+        {
+            if (InUse)
+                InUse->store(false, std::memory_order_release);
+        }
+    };
+
+    std::atomic<uint32_t> NextThreadID{1};
+}
+
+TraceProfiler& TraceProfiler::sGet()
+{
+    static TraceProfiler profiler;
+    return profiler;
+}
+
+TraceProfiler::TraceProfiler()
+{}
+
+TraceProfiler::~TraceProfiler()
+{
+    for (ThreadBuffer* buffer : m_Buffers)
+        delete buffer;
+}
+
+uint64_t TraceProfiler::sGetTime()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+TraceProfiler::ThreadBuffer* TraceProfiler::sGetThreadBuffer()
+{
+    thread_local ThreadBuffer* buffer = nullptr;
+    thread_local ThreadBufferHolder holder;
+
+    if (buffer)
+        return buffer;
+
+    TraceProfiler& profiler = sGet();
+    std::lock_guard<std::mutex> lock(profiler.m_BuffersMutex);
+
+    // Reuse the buffer of a finished thread, e.g. a map loading thread. The ring continues, so the trace
+    // shows both threads on one track.
+    for (ThreadBuffer* free : profiler.m_Buffers)
+    {
+        bool expected = false;
+        if (free->InUse.compare_exchange_strong(expected, true))
+        {
+            buffer = free;
+            break;
+        }
+    }
+
+    if (!buffer)
+    {
+        buffer = new ThreadBuffer;
+        buffer->ThreadID = NextThreadID++;
+        buffer->InUse.store(true, std::memory_order_relaxed);
+        profiler.m_Buffers.Add(buffer);
+    }
+
+    holder.InUse = &buffer->InUse;
+    return buffer;
+}
+
+void TraceProfiler::sWriteEvent(const char* name, bool isBegin)
+{
+    ThreadBuffer* buffer = sGetThreadBuffer();
+
+    uint64_t head = buffer->Head.load(std::memory_order_relaxed);
+
+    Event& event = buffer->Events[head & (ThreadBuffer::Capacity - 1)];
+    event.Name = name;
+    event.Time = sGetTime();
+    event.IsBegin = isBegin;
+
+    buffer->Head.store(head + 1, std::memory_order_release);
+}
+
+void TraceProfiler::sBeginZone(const char* name)
+{
+    sWriteEvent(name, true);
+}
+
+void TraceProfiler::sEndZone()
+{
+    sWriteEvent(nullptr, false);
+}
+
+void TraceProfiler::RegisterCommands()
+{
+    GameApplication::sGetCommandContext().AddCommand("com_TraceCapture", {this, &TraceProfiler::CaptureCommand}, "Capture N frames to a Chrome trace file");
+    GameApplication::sGetCommandContext().AddCommand("com_HitchCapture", {this, &TraceProfiler::HitchCaptureCommand}, "Write a trace when a frame takes longer than MS milliseconds, 0 to disable");
+}
+
+void TraceProfiler::CaptureCommand(CommandProcessor const& proc)
+{
+    int frameCount = proc.GetArgsCount() > 1 ? std::atoi(proc.GetArg(1)) : 1;
+    Capture(frameCount);
+}
+
+void TraceProfiler::HitchCaptureCommand(CommandProcessor const& proc)
+{
+    if (proc.GetArgsCount() < 2)
+    {
+        LOG("Hitch budget: {} ms\n", m_HitchBudgetMs);
+        return;
+    }
+    SetHitchBudget(float(std::atof(proc.GetArg(1))));
+}
+
+void TraceProfiler::Capture(int frameCount)
+{
+    if (frameCount < 1 || IsCapturing())
+        return;
+
+    LOG("Trace capture: {} frames\n", frameCount);
+
+    m_FramesLeft = frameCount;
+    m_CaptureStart = sGetTime();
+    sEnabled.store(true, std::memory_order_relaxed);
+}
+
+void TraceProfiler::SetHitchBudget(float budgetMs)
+{
+    m_HitchBudgetMs = std::max(budgetMs, 0.0f);
+    m_HitchFramesLeft = 0;
+    m_FrameNum = 0;
+
+    if (m_HitchBudgetMs > 0)
+        LOG("Hitch capture: frames over {} ms\n", m_HitchBudgetMs);
+
+    sEnabled.store(m_HitchBudgetMs > 0 || IsCapturing(), std::memory_order_relaxed);
+}
+
+void TraceProfiler::NextFrame()
+{
+    uint64_t time = sGetTime();
+
+    if (m_HitchBudgetMs > 0)
+        UpdateHitchCapture(time);
+
+    if (!IsCapturing())
+        return;
+
+    if (--m_FramesLeft > 0)
+        return;
+
+    sEnabled.store(m_HitchBudgetMs > 0, std::memory_order_relaxed);
+
+    char filename[64];
+    snprintf(filename, sizeof(filename), "trace_%d.json", m_TraceNum++);
+    WriteTrace(filename, m_CaptureStart, time);
+
+    // Writing takes a while, don't report this frame as a hitch
+    m_FrameNum = 0;
+}
+
+void TraceProfiler::UpdateHitchCapture(uint64_t time)
+{
+    if (m_FrameNum > 0 && m_HitchFramesLeft == 0)
+    {
+        uint64_t frameStart = m_FrameStarts[(m_FrameNum - 1) % FrameHistory];
+
+        if ((time - frameStart) / 1000000.0 > m_HitchBudgetMs)
+        {
+            uint64_t framesBefore = std::min<uint64_t>(std::clamp(HitchFramesBefore, 0, FrameHistory - 1), m_FrameNum - 1);
+
+            m_HitchTraceStart = m_FrameStarts[(m_FrameNum - 1 - framesBefore) % FrameHistory];
+            m_HitchFrameStart = frameStart;
+            m_HitchFrameEnd = time;
+            m_HitchFramesLeft = std::max(HitchFramesAfter, 0) + 1;
+        }
+    }
+
+    m_FrameStarts[m_FrameNum % FrameHistory] = time;
+    ++m_FrameNum;
+
+    if (m_HitchFramesLeft == 0 || --m_HitchFramesLeft > 0)
+        return;
+
+    int hitchNum = m_HitchNum++;
+
+    char filename[64];
+    snprintf(filename, sizeof(filename), "hitch_%d.json", hitchNum);
+    WriteTrace(filename, m_HitchTraceStart, time);
+
+    char summaryFilename[64];
+    snprintf(summaryFilename, sizeof(summaryFilename), "hitch_%d.txt", hitchNum);
+    WriteHitchSummary(summaryFilename, filename);
+
+    // Writing takes a while, don't report this frame as the next hitch
+    m_FrameNum = 0;
+}
+
+int TraceProfiler::GatherEvents(ThreadBuffer const* buffer, Vector<Event>& events) const
+{
+    uint64_t head = buffer->Head.load(std::memory_order_acquire);
+    uint64_t tail = head > ThreadBuffer::Capacity ? head - ThreadBuffer::Capacity : 0;
+
+    events.Clear();
+    events.Reserve(head - tail);
+    for (uint64_t i = tail; i < head; ++i)
+        events.Add(buffer->Events[i & (ThreadBuffer::Capacity - 1)]);
+
+    // With hitch capture the owner thread keeps writing. Its next event goes to the slot of event head - Capacity,
+    // so everything from there up to the new head may have been overwritten.
+    uint64_t newHead = buffer->Head.load(std::memory_order_acquire);
+    uint64_t firstValid = newHead >= ThreadBuffer::Capacity ? newHead - ThreadBuffer::Capacity + 1 : 0;
+
+    return int(std::min(std::max(firstValid, tail) - tail, head - tail));
+}
+
+void TraceProfiler::WriteTrace(const char* filename, uint64_t startTime, uint64_t endTime)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+    {
+        LOG("Failed to write trace {}\n", filename);
+        return;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+
+    bool first = true;
+    int eventCount = 0;
+
+    Vector<Event> events;
+
+    std::lock_guard<std::mutex> lock(m_BuffersMutex);
+    for (ThreadBuffer* buffer : m_Buffers)
+    {
+        int firstEvent = GatherEvents(buffer, events);
+
+        // End events carry no name, take it from the matching begin. An end is written only when its begin was.
+        constexpr int MaxDepth = 64;
+        const char* names[MaxDepth];
+        bool written[MaxDepth];
+        int depth = 0;
+
+        for (int i = firstEvent; i < events.Size(); ++i)
+        {
+            Event const& event = events[i];
+            bool inRange = event.Time >= startTime && event.Time <= endTime;
+
+            const char* name;
+            if (event.IsBegin)
+            {
+                name = event.Name;
+                if (depth < MaxDepth)
+                {
+                    names[depth] = name;
+                    written[depth] = inRange;
+                }
+                ++depth;
+                if (!inRange || depth > MaxDepth)
+                    continue;
+            }
+            else
+            {
+                // The begin was overwritten in the ring
+                if (depth == 0)
+                    continue;
+                --depth;
+                if (depth >= MaxDepth || !written[depth])
+                    continue;
+                name = names[depth];
+            }
+
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                    first ? "" : ",\n", name, event.IsBegin ? 'B' : 'E', (event.Time - startTime) / 1000.0, buffer->ThreadID);
+            first = false;
+            ++eventCount;
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    LOG("Trace written to {}: {} events\n", filename, eventCount);
+}
+
+void TraceProfiler::WriteHitchSummary(const char* filename, const char* traceFilename)
+{
+    struct ZoneTime
+    {
+        const char*     Name;
+        uint64_t        Time;
+        int             Count;
+    };
+
+    // Time of each zone inside the long frame. Zones of different threads overlap, so the sum may exceed the frame.
+    Vector<ZoneTime> zones;
+    Vector<Event> events;
+
+    {
+        std::lock_guard<std::mutex> lock(m_BuffersMutex);
+        for (ThreadBuffer* buffer : m_Buffers)
+        {
+            int firstEvent = GatherEvents(buffer, events);
+
+            constexpr int MaxDepth = 64;
+            const char* names[MaxDepth];
+            uint64_t beginTimes[MaxDepth];
+            int depth = 0;
+
+            for (int i = firstEvent; i < events.Size(); ++i)
+            {
+                Event const& event = events[i];
+                if (event.IsBegin)
+                {
+                    if (depth < MaxDepth)
+                    {
+                        names[depth] = event.Name;
+                        beginTimes[depth] = event.Time;
+                    }
+                    ++depth;
+                    continue;
+                }
+
+                if (depth == 0)
+                    continue;
+                --depth;
+                if (depth >= MaxDepth)
+                    continue;
+
+                uint64_t begin = std::max(beginTimes[depth], m_HitchFrameStart);
+                uint64_t end = std::min(event.Time, m_HitchFrameEnd);
+                if (end <= begin)
+                    continue;
+
+                // The same literal may have different addresses in different translation units
+                auto it = std::find_if(zones.begin(), zones.end(), [&](ZoneTime const& zone) { return !strcmp(zone.Name, names[depth]); });
+                if (it == zones.end())
+                    zones.Add({names[depth], end - begin, 1});
+                else
+                {
+                    it->Time += end - begin;
+                    it->Count++;
+                }
+            }
+        }
+    }
+
+    std::sort(zones.begin(), zones.end(), [](ZoneTime const& a, ZoneTime const& b) { return a.Time > b.Time; });
+
+    double frameMs = (m_HitchFrameEnd - m_HitchFrameStart) / 1000000.0;
+
+    FILE* file = fopen(filename, "w");
+    if (file)
+        fprintf(file, "Frame %.2f ms, budget %.2f ms, trace %s\n", frameMs, m_HitchBudgetMs, traceFilename);
+
+    LOG("Hitch: frame {:.2f} ms, budget {:.2f} ms, trace {}\n", frameMs, m_HitchBudgetMs, traceFilename);
+
+    int zoneCount = std::min(HitchTopZones, int(zones.Size()));
+    for (int i = 0; i < zoneCount; ++i)
+    {
+        double zoneMs = zones[i].Time / 1000000.0;
+        if (file)
+            fprintf(file, "%8.2f ms %6d  %s\n", zoneMs, zones[i].Count, zones[i].Name);
+
+        LOG("  {:8.2f} ms {:6}  {}\n", zoneMs, zones[i].Count, zones[i].Name);
+    }
+
+    if (file)
+        fclose(file);
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,182 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2024 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Hork/Core/Containers/Vector.h>
+#include <Hork/Core/String.h>
+
+#include <atomic>
+#include <mutex>
+
+HK_NAMESPACE_BEGIN
+
+class CommandProcessor;
+
+// Scoped zone profiler that writes Chrome/Perfetto JSON traces.
+//
+//     void MoverInterface::FixedUpdate()
+//     {
+//         HK_TRACE_ZONE("FixedUpdate/Movers");
+//         ...
+//     }
+//
+// Zones are written to a ring buffer of the calling thread without locks. When no capture is running a zone
+// costs one relaxed atomic load. The zone name must be a string literal or otherwise outlive the capture.
+//
+// com_TraceCapture N captures the next N frames and writes them to trace_<number>.json in the working directory.
+//
+// With a hitch budget set, zones are recorded all the time and the rings keep the last few seconds. When a frame
+// takes longer than the budget, the frames around it are written to hitch_<number>.json after HitchFramesAfter
+// more frames, and the zones that took most of the long frame to the log and hitch_<number>.txt.
+// com_HitchCapture MS sets the budget in milliseconds, zero turns hitch capture off.
+class TraceProfiler final
+{
+public:
+    // Frames written before and after a long frame
+    int                 HitchFramesBefore = 120;
+    int                 HitchFramesAfter = 30;
+
+    // Zones listed in the hitch summary
+    int                 HitchTopZones = 10;
+
+    static TraceProfiler& sGet();
+
+    static bool         sIsEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+    static void         sBeginZone(const char* name);
+    static void         sEndZone();
+
+    // Registers com_TraceCapture
+    void                RegisterCommands();
+
+    // Starts capturing the next frameCount frames
+    void                Capture(int frameCount);
+
+    bool                IsCapturing() const { return m_FramesLeft > 0; }
+
+    // Sets the frame time budget of hitch capture in milliseconds. Zero disables hitch capture.
+    void                SetHitchBudget(float budgetMs);
+
+    float               GetHitchBudget() const { return m_HitchBudgetMs; }
+
+    // Call once per frame on the main thread. Writes the trace when the capture is done and detects hitches.
+    void                NextFrame();
+
+                        TraceProfiler(TraceProfiler const&) = delete;
+    TraceProfiler&      operator=(TraceProfiler const&) = delete;
+
+private:
+                        TraceProfiler();
+                        ~TraceProfiler();
+
+    struct Event
+    {
+        const char*     Name;
+        uint64_t        Time;
+        bool            IsBegin;
+    };
+
+    // Written only by its thread, read by the main thread when a capture is written
+    struct ThreadBuffer
+    {
+        static constexpr uint32_t Capacity = 1 << 15;
+
+        uint32_t        ThreadID;
+        std::atomic<bool> InUse{false};
+        std::atomic<uint64_t> Head{0};
+        Event           Events[Capacity];
+    };
+
+    static ThreadBuffer* sGetThreadBuffer();
+    static uint64_t     sGetTime();
+    static void         sWriteEvent(const char* name, bool isBegin);
+
+    void                CaptureCommand(CommandProcessor const& proc);
+    void                HitchCaptureCommand(CommandProcessor const& proc);
+    void                UpdateHitchCapture(uint64_t time);
+    void                WriteTrace(const char* filename, uint64_t startTime, uint64_t endTime);
+    void                WriteHitchSummary(const char* filename, const char* traceFilename);
+
+    // Copies the events of the ring. Returns the index of the first event that was not overwritten while copying.
+    int                 GatherEvents(ThreadBuffer const* buffer, Vector<Event>& events) const;
+
+    static std::atomic<bool> sEnabled;
+
+    std::mutex          m_BuffersMutex;
+    Vector<ThreadBuffer*> m_Buffers;
+
+    int                 m_FramesLeft = 0;
+    uint64_t            m_CaptureStart = 0;
+    int                 m_TraceNum = 0;
+
+    // Start times of the last frames
+    static constexpr int FrameHistory = 256;
+    uint64_t            m_FrameStarts[FrameHistory] = {};
+    uint64_t            m_FrameNum = 0;
+
+    float               m_HitchBudgetMs = 0;
+    int                 m_HitchFramesLeft = 0;
+    uint64_t            m_HitchTraceStart = 0;
+    uint64_t            m_HitchFrameStart = 0;
+    uint64_t            m_HitchFrameEnd = 0;
+    int                 m_HitchNum = 0;
+};
+
+class TraceZone final
+{
+public:
+    explicit TraceZone(const char* name)
+    {
+        if (TraceProfiler::sIsEnabled())
+        {
+            TraceProfiler::sBeginZone(name);
+            m_Active = true;
+        }
+    }
+
+    ~TraceZone()
+    {
+        if (m_Active)
+            TraceProfiler::sEndZone();
+    }
+
+    TraceZone(TraceZone const&) = delete;
+    TraceZone& operator=(TraceZone const&) = delete;
+
+private:
+    bool m_Active = false;
+};
+
+#define HK_TRACE_ZONE_CAT2(a, b) a##b
+#define HK_TRACE_ZONE_CAT(a, b) HK_TRACE_ZONE_CAT2(a, b)
+#define HK_TRACE_ZONE(name) ::Hk::TraceZone HK_TRACE_ZONE_CAT(traceZone_, __LINE__)(name)
+
+HK_NAMESPACE_END